@@ -2,20 +2,57 @@
 
 #include <optional>
 #include <polar/asset/material.h>
-#include <polar/asset/triangle.h>
+#include <polar/asset/packedvertex.h>
+#include <polar/asset/vertex.h>
 
 namespace polar::asset {
+	// simplified triangles over the vertices of the full mesh, drawn in its place from further away
+	struct modellod {
+		std::vector<uint32_t> indices;
+
+		// how far the surface may have moved from the full mesh, in model units
+		float error = 0;
+	};
+
+	inline serializer &operator<<(serializer &s, const modellod &asset) { return s << asset.indices << asset.error; }
+
+	inline deserializer &operator>>(deserializer &s, modellod &asset) { return s >> asset.indices >> asset.error; }
+
 	struct model : base {
-		std::vector<triangle> triangles;
+		// welded vertices, three indices per triangle
+		std::vector<vertex> vertices;
+		std::vector<uint32_t> indices;
+
+		/* compact meshes store packed vertices instead, positions are
+		 * center + position * extent
+		 */
+		std::vector<packedvertex> packed;
+		math::point3 center = math::point3(0);
+		float extent        = 1;
+
+		// model space bounds, a negative radius means they were never computed
+		math::point3 boundsMin = math::point3(0);
+		math::point3 boundsMax = math::point3(0);
+		float radius           = -1;
+
 		std::optional<asset_ref<material>> material;
+
+		// coarser levels of detail in order of increasing error, the full mesh is level 0
+		std::vector<modellod> lods;
+
+		inline bool compact() const { return !packed.empty(); }
+		inline bool hasbounds() const { return radius >= 0; }
+		inline math::point3 boundscenter() const { return (boundsMin + boundsMax) * 0.5f; }
 	};
 
 	inline serializer &operator<<(serializer &s, const model &asset) {
-		return s << asset.triangles << asset.material;
+		return s << asset.vertices << asset.indices << asset.packed << asset.center << asset.extent
+		         << asset.boundsMin << asset.boundsMax << asset.radius << asset.material << asset.lods;
 	}
 
 	inline deserializer &operator>>(deserializer &s, model &asset) {
-		return s >> asset.triangles >> asset.material;
+		return s >> asset.vertices >> asset.indices >> asset.packed >> asset.center >> asset.extent
+		         >> asset.boundsMin >> asset.boundsMax >> asset.radius >> asset.material >> asset.lods;
 	}
 
 	template<> inline std::string name<model>() { return "model"; }
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <array>
+#include <polar/asset/base.h>
+
+namespace polar::asset {
+	/* compact vertex layout, 16 bytes instead of 32
+	 *
+	 *   position   4 x snorm16, relative to the mesh bounds, w unused
+	 *   normal     snorm 2_10_10_10_REV
+	 *   texcoord   2 x half float
+	 */
+	struct packedvertex {
+		std::array<int16_t, 4> position  = {{0, 0, 0, 0}};
+		uint32_t normal                  = 0;
+		std::array<uint16_t, 2> texcoord = {{0, 0}};
+	};
+
+	inline serializer &operator<<(serializer &s, const packedvertex &asset) {
+		return s << asset.position << asset.normal << asset.texcoord;
+	}
+
+	inline deserializer &operator>>(deserializer &s, packedvertex &asset) {
+		return s >> asset.position >> asset.normal >> asset.texcoord;
+	}
+} // namespace polar::asset
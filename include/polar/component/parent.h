@@ -0,0 +1,16 @@
+#pragma once
+
+#include <polar/component/base.h>
+#include <polar/core/ref.h>
+
+namespace polar::component {
+	// attaches an object to another so its transform is relative to the parent's world transform
+	class parent : public base {
+	  public:
+		core::weak_ref target;
+
+		parent(core::weak_ref target) : target(target) {}
+
+		virtual std::string name() const override { return "parent"; }
+	};
+} // namespace polar::component
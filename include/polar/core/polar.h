@@ -86,8 +86,6 @@ namespace polar::core {
 		std::vector<std::pair<weak_ref, std::type_index>> components_to_remove;
 
 		component::base *get(weak_ref, std::type_index);
-		std::shared_ptr<component::base> insert(weak_ref, std::shared_ptr<component::base>, std::type_index);
-		void remove_now(weak_ref, std::type_index);
 
 		void remove(weak_ref r, std::type_index ti) { components_to_remove.emplace_back(r, ti); }
 
@@ -125,6 +123,10 @@ namespace polar::core {
 		void insert(std::type_index, std::shared_ptr<system::base>);
 		void remove_now(weak_ref);
 
+		// untyped variants used to restore relations, e.g. by system::snapshot
+		std::shared_ptr<component::base> insert(weak_ref, std::shared_ptr<component::base>, std::type_index);
+		void remove_now(weak_ref, std::type_index);
+
 		void remove(weak_ref r) { objects_to_remove.emplace_back(r); }
 
 		template<
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <polar/math/mat.h>
+#include <polar/math/point.h>
+
+namespace polar::math {
+	/* six inward facing planes (xyz normal, w distance) extracted from a
+	 * view projection matrix, anything in front of every plane is visible
+	 */
+	struct frustum {
+		std::array<point4, 6> planes;
+
+		frustum() = default;
+
+		explicit frustum(const mat4x4 &viewProj) {
+			auto row = [&viewProj] (int i) {
+				return point4(viewProj[0][i], viewProj[1][i], viewProj[2][i], viewProj[3][i]);
+			};
+
+			auto r0 = row(0), r1 = row(1), r2 = row(2), r3 = row(3);
+			planes = {{r3 + r0, r3 - r0, r3 + r1, r3 - r1, r3 + r2, r3 - r2}};
+
+			for(auto &p : planes) {
+				auto len = std::sqrt(p.x * p.x + p.y * p.y + p.z * p.z);
+				if(len > 0) { p /= len; }
+			}
+		}
+
+		inline bool intersects(const point3 &center, decimal radius) const {
+			for(auto &p : planes) {
+				if(p.x * center.x + p.y * center.y + p.z * center.z + p.w < -radius) { return false; }
+			}
+			return true;
+		}
+
+		/* tests spheres stored as separate coordinate arrays, the inner loop has
+		 * no branches so the compiler can vectorize it
+		 */
+		void cull(const float *x, const float *y, const float *z, const float *r, uint8_t *visible,
+		          size_t n) const {
+			std::fill(visible, visible + n, uint8_t(1));
+			for(auto &p : planes) {
+				const float px = p.x, py = p.y, pz = p.z, pw = p.w;
+				for(size_t i = 0; i < n; ++i) {
+					visible[i] &= uint8_t(px * x[i] + py * y[i] + pz * z[i] + pw >= -r[i]);
+				}
+			}
+		}
+	};
+
+	/* smallest perspective projection containing both frusta, assuming they
+	 * share an apex as both VR eyes do here, so one cull covers both eyes
+	 */
+	inline mat4x4 combine_projections(const mat4x4 &a, const mat4x4 &b, decimal zNear, decimal zFar) {
+		// recover the near plane extents from the off-axis terms
+		auto extents = [zNear] (const mat4x4 &p) {
+			return point4(zNear * (p[2][0] - 1) / p[0][0], zNear * (p[2][0] + 1) / p[0][0],
+			              zNear * (p[2][1] - 1) / p[1][1], zNear * (p[2][1] + 1) / p[1][1]);
+		};
+
+		auto ea = extents(a), eb = extents(b);
+		return glm::frustum(std::min(ea.x, eb.x), std::max(ea.y, eb.y), std::min(ea.z, eb.z), std::max(ea.w, eb.w),
+		                    zNear, zFar);
+	}
+} // namespace polar::math
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <polar/math/mat.h>
+#include <polar/math/point.h>
 #include <polar/util/gl.h>
+#include <string>
 #include <vector>
 
 namespace polar {
@@ -10,15 +13,46 @@ namespace polar {
 				GLuint vao;
 				std::vector<GLuint> vbos;
 				GLsizei numVertices = 0;
-				GLsizei capacity    = 0;
+				GLsizeiptr capacity = 0;
 
-				GLuint diffuse_map;
-				GLuint specular_map;
-				GLuint normal_map;
+				// compact vertices are dequantized by folding the mesh bounds into the model matrix
+				bool compact            = false;
+				math::mat4x4 dequantize = math::mat4x4(1);
 
-				inline friend bool operator<(const model &left, const model &right) {
-					return left.capacity < right.capacity;
-				}
+				// bounding sphere in the space of the draw transform, negative radius disables culling
+				math::point3 cullCenter = math::point3(0);
+				float cullRadius        = -1;
+
+				// element buffer, 16 bit indices whenever the vertex count allows it
+				GLuint ebo            = 0;
+				GLsizei numIndices    = 0;
+				GLsizeiptr indexBytes = 0;
+				GLenum indexType      = GL_UNSIGNED_INT;
+
+				// ranges of the element buffer drawn at each level of detail, level 0 is the full mesh
+				struct lod {
+					GLsizei count;
+					const GLvoid *offset;
+
+					// surface error in the space of the draw transform
+					float error;
+				};
+				std::vector<lod> lods;
+
+				GLuint diffuse_map  = 0;
+				GLuint specular_map = 0;
+				GLuint normal_map   = 0;
+
+				// polar_material block shared with every other model using the same material
+				GLuint material_ubo = 0;
+
+				// cache keys of the shared textures and material block, released with the mesh
+				std::vector<std::string> textureKeys;
+				std::string materialKey;
+
+				// small ids used to build draw sort keys
+				uint32_t mesh_id     = 0;
+				uint32_t material_id = 0;
 			};
 		} // namespace gl32
 	}     // namespace property
@@ -1,12 +1,19 @@
 #pragma once
 
+#include <polar/math/point.h>
 #include <polar/util/gl.h>
 
 namespace polar {
 	namespace property {
 		namespace gl32 {
 			struct sprite : public base {
-				GLuint texture;
+				// region of the shared sprite atlas, top left and bottom right corners
+				bool atlased       = false;
+				math::point2 uvMin = math::point2(0);
+				math::point2 uvMax = math::point2(0);
+
+				// sprites too large for the atlas keep their own texture
+				GLuint texture = 0;
 			};
 		} // namespace gl32
 	}     // namespace property
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <polar/math/point.h>
+#include <string>
+#include <vector>
+
+namespace polar {
+	namespace property {
+		namespace gl32 {
+			// glyph quads in text space, rebuilt only when the string or its anchoring changes
+			struct text : public base {
+				struct vertex {
+					math::point2 position;
+					math::point2 texcoord;
+				};
+
+				std::string str;
+				math::decimal offsetY = 0;
+				std::vector<vertex> vertices;
+			};
+		} // namespace gl32
+	}     // namespace property
+} // namespace polar
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace polar::support::gl32 {
+	struct drawpacket {
+		uint64_t key;
+		uint32_t index;
+	};
+
+	/* draw packets ordered by a 64 bit key so that consecutive draws share as
+	 * much state as possible
+	 *
+	 * key layout, most significant first:
+	 *
+	 *   bits   field
+	 *      4   pass
+	 *      8   program
+	 *     12   material
+	 *     12   mesh
+	 *     12   texture
+	 *     16   depth
+	 */
+	class drawqueue {
+		std::vector<drawpacket> packets;
+		std::vector<drawpacket> scratch;
+
+	  public:
+		static inline uint64_t makekey(uint64_t pass, uint64_t program, uint64_t material, uint64_t mesh,
+		                               uint64_t texture, uint64_t depth) {
+			return (pass & 0xf) << 60 | (program & 0xff) << 52 | (material & 0xfff) << 40 | (mesh & 0xfff) << 28 |
+			       (texture & 0xfff) << 16 | (depth & 0xffff);
+		}
+
+		// linear depth between the clip planes mapped onto the key's 16 bit depth field
+		static inline uint16_t quantize(float depth, float zNear, float zFar) {
+			float t = (depth - zNear) / (zFar - zNear);
+			if(!(t > 0)) { return 0; }
+			if(t >= 1) { return 0xffff; }
+			return uint16_t(t * float(0xffff));
+		}
+
+		inline size_t size() const { return packets.size(); }
+		inline bool empty() const { return packets.empty(); }
+		inline void clear() { packets.clear(); }
+
+		// packets are written in place by index, which lets worker threads fill disjoint ranges
+		inline void resize(size_t n) { packets.resize(n); }
+		inline drawpacket &operator[](size_t i) { return packets[i]; }
+		inline const drawpacket &operator[](size_t i) const { return packets[i]; }
+
+		inline void push(uint64_t key, uint32_t index) { packets.emplace_back(drawpacket{key, index}); }
+
+		// drop packets in place, keeping the order of the rest
+		template<typename Pred> inline void remove_if(Pred pred) {
+			packets.erase(std::remove_if(packets.begin(), packets.end(), pred), packets.end());
+		}
+
+		inline auto begin() const { return packets.cbegin(); }
+		inline auto end() const { return packets.cend(); }
+
+		// stable LSD radix sort, one byte per pass, skipping bytes every key has in common
+		void sort() {
+			auto n = packets.size();
+			if(n < 2) { return; }
+
+			uint64_t all = ~uint64_t(0), any = 0;
+			for(auto &p : packets) {
+				all &= p.key;
+				any |= p.key;
+			}
+			uint64_t varying = all ^ any;
+
+			scratch.resize(n);
+			for(unsigned int shift = 0; shift < 64; shift += 8) {
+				if(((varying >> shift) & 0xff) == 0) { continue; }
+
+				std::array<size_t, 257> offsets{};
+				for(auto &p : packets) { ++offsets[((p.key >> shift) & 0xff) + 1]; }
+				for(size_t b = 1; b < offsets.size(); ++b) { offsets[b] += offsets[b - 1]; }
+				for(auto &p : packets) { scratch[offsets[(p.key >> shift) & 0xff]++] = p; }
+
+				packets.swap(scratch);
+			}
+		}
+	};
+
+	/* small ids for the 12 bit material and mesh key fields, released ids are
+	 * handed out again so they stay within the field while fewer than 4095 are
+	 * live, past that 0 is returned and those draws only lose their grouping
+	 */
+	class keyids {
+		std::vector<uint32_t> free;
+		uint32_t next = 1;
+
+	  public:
+		static const uint32_t limit = 0xfff;
+
+		inline uint32_t acquire() {
+			if(!free.empty()) {
+				auto id = free.back();
+				free.pop_back();
+				return id;
+			}
+			return next <= limit ? next++ : 0;
+		}
+
+		inline void release(uint32_t id) {
+			if(id != 0) { free.emplace_back(id); }
+		}
+	};
+} // namespace polar::support::gl32
@@ -1,15 +1,22 @@
 #pragma once
 
 #include <array>
+#include <polar/math/point.h>
 #include <polar/util/gl.h>
 
 namespace polar::support::gl32 {
 	struct fontcache_entry {
 		bool active = false;
-		GLuint texture;
+
+		// texture coordinates of the glyph's top left and bottom right corners in the atlas
+		math::point2 uvMin = math::point2(0);
+		math::point2 uvMax = math::point2(0);
 	};
 
+	// every glyph of a font packed into one atlas texture
 	struct fontcache {
+		GLuint texture = 0;
+		math::point2i size = math::point2i(0);
 		std::array<fontcache_entry, 128> entries;
 	};
 } // namespace polar::support::gl32
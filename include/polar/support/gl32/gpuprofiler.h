@@ -0,0 +1,185 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <iomanip>
+#include <polar/fs/local.h>
+#include <polar/util/gl.h>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace polar::support::gl32 {
+	/* GPU time spent in named scopes, measured with timestamp queries
+	 *
+	 * every frame records into its own pool of queries and is read back a few
+	 * frames later, a frame whose results are still not available by then is
+	 * dropped rather than waited on, so the CPU never stalls on the GPU
+	 *
+	 * scopes may nest, their timestamps can also be exported as a Chrome trace
+	 */
+	class gpuprofiler {
+	  public:
+		static const size_t latency = 3;
+
+		struct scope {
+			std::string name;
+			size_t depth;
+			GLuint64 begin = 0;
+			GLuint64 end   = 0;
+
+			inline float ms() const { return float(end - begin) / 1000000.0f; }
+		};
+
+	  private:
+		struct frame {
+			std::vector<scope> scopes;
+			std::vector<GLuint> queries;
+			GLuint last  = 0;
+			bool pending = false;
+		};
+
+		std::array<frame, latency> frames;
+		size_t current = 0;
+		std::vector<size_t> open;
+
+		bool supported = false;
+		bool enabled   = true;
+
+		std::vector<scope> results;
+		size_t dropped = 0;
+
+		size_t traceFrames   = 0;
+		GLuint64 traceOrigin = 0;
+		std::ostringstream trace;
+		core::path tracePath = "";
+
+		inline GLuint query(frame &f, size_t i) {
+			while(f.queries.size() <= i) {
+				GLuint id;
+				GL(glGenQueries(1, &id));
+				f.queries.emplace_back(id);
+			}
+			return f.queries[i];
+		}
+
+		void collect(frame &f) {
+			f.pending = false;
+			if(f.scopes.empty()) { return; }
+
+			// the last query issued is the last to complete
+			GLint available = GL_FALSE;
+			GL(glGetQueryObjectiv(f.last, GL_QUERY_RESULT_AVAILABLE, &available));
+			if(!available) {
+				++dropped;
+				return;
+			}
+
+			for(size_t i = 0; i < f.scopes.size(); ++i) {
+				GL(glGetQueryObjectui64v(f.queries[i * 2], GL_QUERY_RESULT, &f.scopes[i].begin));
+				GL(glGetQueryObjectui64v(f.queries[i * 2 + 1], GL_QUERY_RESULT, &f.scopes[i].end));
+			}
+			results = f.scopes;
+
+			if(traceFrames > 0) { record(); }
+		}
+
+		void record() {
+			if(traceOrigin == 0) { traceOrigin = results.front().begin; }
+
+			for(auto &s : results) {
+				if(trace.tellp() > 0) { trace << ",\n"; }
+				trace << "{\"name\":\"" << s.name << "\",\"ph\":\"X\",\"pid\":0,\"tid\":0"
+				      << ",\"ts\":" << double(s.begin - traceOrigin) / 1000.0
+				      << ",\"dur\":" << double(s.end - s.begin) / 1000.0 << '}';
+			}
+
+			if(--traceFrames == 0) {
+				fs::local::write(tracePath, "{\"traceEvents\":[\n" + trace.str() + "\n]}\n");
+				log()->info("gl", "wrote GPU trace to ", tracePath);
+			}
+		}
+
+	  public:
+		void init() {
+			supported = GLEW_VERSION_3_3 || GLEW_ARB_timer_query;
+			if(!supported) { log()->verbose("gl", "ARB_timer_query unsupported, GPU profiling disabled"); }
+		}
+
+		inline bool active() const { return supported && enabled; }
+		inline bool getenabled() const { return enabled; }
+		inline void setenabled(bool e) { enabled = e; }
+
+		void begin(const std::string &name) {
+			if(!active()) { return; }
+
+			auto &f = frames[current];
+			auto i  = f.scopes.size();
+			f.scopes.emplace_back(scope{name, open.size()});
+			open.emplace_back(i);
+
+			f.last = query(f, i * 2);
+			GL(glQueryCounter(f.last, GL_TIMESTAMP));
+		}
+
+		void end() {
+			if(!active() || open.empty()) { return; }
+
+			auto &f = frames[current];
+			f.last  = query(f, open.back() * 2 + 1);
+			GL(glQueryCounter(f.last, GL_TIMESTAMP));
+			open.pop_back();
+		}
+
+		// after the frame is submitted, reads back the oldest frame whose slot is about to be reused
+		void endframe() {
+			while(active() && !open.empty()) { end(); }
+			open.clear();
+
+			frames[current].pending = !frames[current].scopes.empty();
+			current                 = (current + 1) % latency;
+
+			auto &f = frames[current];
+			if(f.pending) { collect(f); }
+			f.scopes.clear();
+		}
+
+		// captures the next given number of completed frames into a Chrome trace at path
+		void capture(size_t count, core::path path) {
+			traceFrames = count;
+			traceOrigin = 0;
+			tracePath   = path;
+			trace.str("");
+			trace.clear();
+
+			// microseconds past a second would otherwise print in scientific notation and lose resolution
+			trace << std::fixed << std::setprecision(3);
+		}
+
+		inline size_t capturing() const { return traceFrames; }
+
+		// summed over every scope of that name, stereo frames render each pass twice
+		float ms(const std::string &name) const {
+			float total = 0;
+			for(auto &s : results) {
+				if(s.name == name) { total += s.ms(); }
+			}
+			return total;
+		}
+
+		// from the first query of the frame to the last
+		float framems() const {
+			if(results.empty()) { return 0; }
+
+			GLuint64 first = results.front().begin, last = results.front().end;
+			for(auto &s : results) {
+				first = std::min(first, s.begin);
+				last  = std::max(last, s.end);
+			}
+			return float(last - first) / 1000000.0f;
+		}
+
+		inline const std::vector<scope> &latest() const { return results; }
+		inline size_t droppedframes() const { return dropped; }
+	};
+} // namespace polar::support::gl32
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <polar/math/mat.h>
+#include <polar/math/point.h>
+#include <vector>
+
+namespace polar::support::gl32 {
+	/* CPU side hierarchical depth buffer built from a downsampled read back of
+	 * an earlier frame's depth, each texel holds the farthest depth it covers
+	 *
+	 * a bounding sphere is occluded when its nearest point lies behind the
+	 * farthest depth of every texel it touches
+	 */
+	class hizbuffer {
+		struct level {
+			int width;
+			int height;
+			std::vector<float> depth;
+
+			inline float at(int x, int y) const { return depth[size_t(y) * size_t(width) + size_t(x)]; }
+		};
+
+		std::vector<level> levels;
+		math::mat4x4 viewProj = math::mat4x4(1);
+		bool valid            = false;
+
+	  public:
+		inline bool ready() const { return valid; }
+		inline void invalidate() { valid = false; }
+
+		// depth is bottom-up as read back by glReadPixels, captured with the given view projection
+		void build(const float *depth, int width, int height, const math::mat4x4 &capturedViewProj) {
+			viewProj = capturedViewProj;
+
+			levels.resize(1);
+			levels[0].width  = width;
+			levels[0].height = height;
+			levels[0].depth.assign(depth, depth + size_t(width) * size_t(height));
+
+			while(levels.back().width > 1 || levels.back().height > 1) {
+				auto &prev = levels.back();
+
+				level next;
+				next.width  = std::max(1, (prev.width + 1) / 2);
+				next.height = std::max(1, (prev.height + 1) / 2);
+				next.depth.resize(size_t(next.width) * size_t(next.height));
+
+				for(int y = 0; y < next.height; ++y) {
+					int y0 = std::min(y * 2, prev.height - 1), y1 = std::min(y * 2 + 1, prev.height - 1);
+					for(int x = 0; x < next.width; ++x) {
+						int x0 = std::min(x * 2, prev.width - 1), x1 = std::min(x * 2 + 1, prev.width - 1);
+						auto top    = std::max(prev.at(x0, y0), prev.at(x1, y0));
+						auto bottom = std::max(prev.at(x0, y1), prev.at(x1, y1));
+						next.depth[size_t(y) * size_t(next.width) + size_t(x)] = std::max(top, bottom);
+					}
+				}
+
+				levels.emplace_back(std::move(next));
+			}
+
+			valid = true;
+		}
+
+		bool occluded(const math::point3 &center, math::decimal radius) const {
+			if(!valid || !std::isfinite(radius)) { return false; }
+
+			// project the corners of the sphere's box into the captured frame
+			float minX = 1, minY = 1, maxX = -1, maxY = -1, minZ = 1;
+			for(int i = 0; i < 8; ++i) {
+				math::point4 corner(center.x + (i & 1 ? radius : -radius), center.y + (i & 2 ? radius : -radius),
+				                    center.z + (i & 4 ? radius : -radius), 1);
+				auto clip = viewProj * corner;
+
+				// anything reaching behind the camera cannot be tested safely
+				if(clip.w <= 0) { return false; }
+
+				float x = clip.x / clip.w, y = clip.y / clip.w, z = clip.z / clip.w;
+				minX = std::min(minX, x);
+				maxX = std::max(maxX, x);
+				minY = std::min(minY, y);
+				maxY = std::max(maxY, y);
+				minZ = std::min(minZ, z);
+			}
+
+			float nearest = minZ * 0.5f + 0.5f;
+			if(nearest <= 0) { return false; }
+
+			minX = std::max(minX, -1.0f);
+			minY = std::max(minY, -1.0f);
+			maxX = std::min(maxX, 1.0f);
+			maxY = std::min(maxY, 1.0f);
+			if(minX > maxX || minY > maxY) { return false; }
+
+			auto &base = levels[0];
+			int x0     = std::min(base.width - 1, int((minX * 0.5f + 0.5f) * base.width));
+			int x1     = std::min(base.width - 1, int((maxX * 0.5f + 0.5f) * base.width));
+			int y0     = std::min(base.height - 1, int((minY * 0.5f + 0.5f) * base.height));
+			int y1     = std::min(base.height - 1, int((maxY * 0.5f + 0.5f) * base.height));
+
+			// pick the level where the rectangle spans about two texels
+			int span = std::max(x1 - x0, y1 - y0) + 1;
+			size_t l = 0;
+			while(span > 2 && l + 1 < levels.size()) {
+				span = (span + 1) / 2;
+				++l;
+			}
+
+			auto &lvl = levels[l];
+			x0 >>= l;
+			x1 >>= l;
+			y0 >>= l;
+			y1 >>= l;
+
+			for(int y = y0; y <= std::min(y1, lvl.height - 1); ++y) {
+				for(int x = x0; x <= std::min(x1, lvl.width - 1); ++x) {
+					if(nearest <= lvl.at(x, y)) { return false; }
+				}
+			}
+			return true;
+		}
+	};
+} // namespace polar::support::gl32
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <polar/support/gl32/uniformcache.h>
 #include <polar/util/gl.h>
 #include <unordered_map>
 #include <unordered_set>
@@ -9,6 +10,15 @@ namespace polar::support::gl32 {
 		GLuint program;
 		GLuint fbo = 0;
 
+		// depth output if the program declares one, feeds occlusion culling
+		GLuint depthOut = 0;
+
+		// programs declaring a_instanceModel (and optionally a_instanceColor) are drawn instanced
+		GLint instanceModelLoc = -1;
+		GLint instanceColorLoc = -1;
+
+		uniformcache locations;
+
 		std::unordered_set<std::string> uniforms;
 		std::unordered_map<std::string, GLuint> outs;
 		std::unordered_map<std::string, std::string> ins;
@@ -16,5 +26,7 @@ namespace polar::support::gl32 {
 		std::unordered_map<std::string, std::string> globalIns;
 
 		pipelinenode(GLuint program) : program(program) {}
+
+		inline bool instanced() const { return instanceModelLoc >= 0; }
 	};
 } // namespace polar::support::gl32
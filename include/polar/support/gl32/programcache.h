@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstring>
+#include <iomanip>
+#include <polar/asset/shaderprogram.h>
+#include <polar/fs/local.h>
+#include <polar/util/gl.h>
+#include <sstream>
+#include <string>
+
+namespace polar::support::gl32 {
+	/* linked program binaries kept on disk between runs
+	 *
+	 * entries are keyed by the shader sources and the driver's vendor, renderer
+	 * and version strings, so a driver update misses and relinks rather than
+	 * feeding it a stale binary, and a binary the driver rejects is dropped
+	 */
+	class programcache {
+		core::path dir = "";
+		std::string driver;
+		bool supported = false;
+
+		static inline uint64_t fnv(uint64_t hash, const void *data, size_t len) {
+			auto bytes = static_cast<const uint8_t *>(data);
+			for(size_t i = 0; i < len; ++i) {
+				hash ^= bytes[i];
+				hash *= 1099511628211ull;
+			}
+			return hash;
+		}
+
+		static inline std::string glstring(GLenum name) {
+			const GLubyte *str;
+			GL(str = glGetString(name));
+			return str != nullptr ? reinterpret_cast<const char *>(str) : "";
+		}
+
+		inline core::path file(const std::string &key) const { return dir / (key + ".bin"); }
+
+	  public:
+		void init(core::path cacheDir) {
+			dir = cacheDir;
+
+			GLint formats = 0;
+			if(GLEW_ARB_get_program_binary) { GL(glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats)); }
+			supported = formats > 0;
+			if(!supported) { log()->verbose("gl", "program binaries unsupported, linking every program at startup"); }
+
+			driver = glstring(GL_VENDOR) + '\n' + glstring(GL_RENDERER) + '\n' + glstring(GL_VERSION);
+		}
+
+		inline bool enabled() const { return supported; }
+
+		std::string key(const polar::asset::shaderprogram &as) const {
+			uint64_t hash = fnv(14695981039346656037ull, driver.data(), driver.size());
+			for(auto &shader : as.shaders) {
+				auto type = static_cast<uint8_t>(shader.type);
+				hash      = fnv(hash, &type, sizeof(type));
+				hash      = fnv(hash, shader.source.data(), shader.source.size());
+			}
+
+			std::ostringstream oss;
+			oss << std::hex << std::setw(16) << std::setfill('0') << hash;
+			return oss.str();
+		}
+
+		// a linked program, or 0 when nothing usable is cached under key
+		GLuint load(const std::string &key) {
+			if(!supported || !fs::local::exists(file(key))) { return 0; }
+
+			auto data = fs::local::read(file(key));
+			if(data.size() <= sizeof(GLenum)) { return 0; }
+
+			GLenum format;
+			std::memcpy(&format, data.data(), sizeof(format));
+
+			GLuint program;
+			GL(program = glCreateProgram());
+			GL(glProgramBinary(program, format, data.data() + sizeof(format), GLsizei(data.size() - sizeof(format))));
+
+			GLint status = GL_FALSE;
+			GL(glGetProgramiv(program, GL_LINK_STATUS, &status));
+			if(status == GL_FALSE) {
+				log()->verbose("gl", "driver rejected cached program ", key);
+				GL(glDeleteProgram(program));
+				fs::local::remove_file(file(key));
+				return 0;
+			}
+
+			return program;
+		}
+
+		// has to be set before linking for the driver to keep the binary
+		void hint(GLuint program) const {
+			if(supported) { GL(glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE)); }
+		}
+
+		void store(GLuint program, const std::string &key) const {
+			if(!supported) { return; }
+
+			GLint length = 0;
+			GL(glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length));
+			if(length <= 0) { return; }
+
+			// stored as the binary format followed by the binary itself
+			std::string data(sizeof(GLenum) + size_t(length), '\0');
+			GLenum format   = 0;
+			GLsizei written = 0;
+			GL(glGetProgramBinary(program, length, &written, &format, &data[sizeof(GLenum)]));
+			if(written <= 0) { return; }
+
+			std::memcpy(&data[0], &format, sizeof(format));
+			data.resize(sizeof(GLenum) + size_t(written));
+			fs::local::write(file(key), data);
+		}
+	};
+} // namespace polar::support::gl32
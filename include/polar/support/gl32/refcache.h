@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <unordered_map>
+
+namespace polar::support::gl32 {
+	/* GPU resources shared by every user of the same key, created on first
+	 * acquire and destroyed when the last user releases them
+	 */
+	template<typename Key, typename Value> class refcache {
+		struct slot {
+			Value value;
+			size_t bytes = 0;
+			size_t refs  = 0;
+		};
+
+		std::unordered_map<Key, slot> slots;
+		size_t resident = 0;
+
+	  public:
+		// make() is only called on a miss and returns {value, resident bytes}
+		template<typename Make> Value &acquire(const Key &key, Make make) {
+			auto it = slots.find(key);
+			if(it == slots.end()) {
+				auto made = make();
+				it        = slots.emplace(key, slot{made.first, made.second, 0}).first;
+				resident += made.second;
+			}
+			++it->second.refs;
+			return it->second.value;
+		}
+
+		// destroy() receives the value once its last reference is gone
+		template<typename Destroy> void release(const Key &key, Destroy destroy) {
+			auto it = slots.find(key);
+			if(it == slots.end() || --it->second.refs > 0) { return; }
+
+			resident -= it->second.bytes;
+			destroy(it->second.value);
+			slots.erase(it);
+		}
+
+		inline Value *find(const Key &key) {
+			auto it = slots.find(key);
+			return it != slots.end() ? &it->second.value : nullptr;
+		}
+
+		inline size_t refs(const Key &key) const {
+			auto it = slots.find(key);
+			return it != slots.end() ? it->second.refs : 0;
+		}
+
+		inline size_t size() const { return slots.size(); }
+		inline size_t bytes() const { return resident; }
+	};
+} // namespace polar::support::gl32
@@ -0,0 +1,115 @@
+#pragma once
+
+namespace polar::support::gl32::shaders {
+	// renderer internal programs which do not depend on any shader assets
+
+	inline const char *batch_vertex = R"(#version 150
+#extension GL_ARB_explicit_attrib_location: enable
+layout(location=0) in vec4 a_position;
+layout(location=1) in vec2 a_texcoord;
+layout(location=2) in vec4 a_color;
+out vec2 v_texcoord;
+out vec4 v_color;
+void main() {
+	v_texcoord = a_texcoord;
+	v_color = a_color;
+	gl_Position = a_position;
+}
+)";
+
+	inline const char *batch_fragment = R"(#version 150
+uniform sampler2D u_texture;
+in vec2 v_texcoord;
+in vec4 v_color;
+out vec4 o_color;
+void main() {
+	o_color = texture(u_texture, v_texcoord) * v_color;
+}
+)";
+
+	// reduces the depth buffer to the farthest depth of each u_footprint sized block
+	inline const char *hiz_vertex = R"(#version 150
+#extension GL_ARB_explicit_attrib_location: enable
+layout(location=0) in vec2 a_position;
+void main() {
+	gl_Position = vec4(a_position, 0.0, 1.0);
+}
+)";
+
+	inline const char *hiz_fragment = R"(#version 150
+uniform sampler2D u_texture;
+uniform ivec2 u_footprint;
+uniform ivec2 u_extent;
+out float o_depth;
+void main() {
+	ivec2 size = min(textureSize(u_texture, 0), u_extent) - ivec2(1);
+	ivec2 base = ivec2(gl_FragCoord.xy) * u_footprint;
+	float depth = 0.0;
+	for(int y = 0; y < u_footprint.y; ++y) {
+		for(int x = 0; x < u_footprint.x; ++x) {
+			depth = max(depth, texelFetch(u_texture, min(base + ivec2(x, y), size), 0).r);
+		}
+	}
+	o_depth = depth;
+}
+)";
+
+	// stretches the u_renderScale corner of a target over the output, drawn with hiz_vertex
+	inline const char *upscale_fragment = R"(#version 150
+uniform sampler2D u_texture;
+uniform vec2 u_renderScale;
+uniform vec2 u_output;
+out vec4 o_color;
+vec4 fetch(ivec2 p, ivec2 hi) {
+	return texelFetch(u_texture, clamp(p, ivec2(0), hi), 0);
+}
+void main() {
+	vec2 extent = vec2(textureSize(u_texture, 0)) * u_renderScale;
+	ivec2 hi = ivec2(extent) - ivec2(1);
+	vec2 p = gl_FragCoord.xy / u_output * extent - 0.5;
+	ivec2 i = ivec2(floor(p));
+	vec2 f = fract(p);
+	vec4 bottom = mix(fetch(i, hi), fetch(i + ivec2(1, 0), hi), f.x);
+	vec4 top = mix(fetch(i + ivec2(0, 1), hi), fetch(i + ivec2(1, 1), hi), f.x);
+	o_color = mix(bottom, top, f.y);
+}
+)";
+
+	/* debug shapes, lines and points from system::debugdraw, shapes take
+	 * their transform and colour per instance and lines and points per vertex
+	 *
+	 * draws with more than one instance render both eyes of single-pass stereo
+	 */
+	inline const char *debug_vertex = R"(#version 150
+#extension GL_ARB_explicit_attrib_location: enable
+layout(std140) uniform polar_frame {
+	mat4 polar_projection[2];
+	mat4 polar_view[2];
+	mat4 polar_invViewProj[2];
+	vec4 polar_stereo;
+};
+uniform int polar_instances;
+layout(location=0) in vec3 a_position;
+layout(location=1) in vec4 a_color;
+layout(location=2) in mat4 a_transform;
+out vec4 v_color;
+void main() {
+	int eye = polar_instances > 1 ? gl_InstanceID % 2 : 0;
+	v_color = a_color;
+	gl_Position = polar_projection[eye] * polar_view[eye] * a_transform * vec4(a_position, 1.0);
+	if(polar_instances > 1) {
+		float side = float(eye) * 2.0 - 1.0;
+		gl_ClipDistance[0] = gl_Position.w + side * gl_Position.x;
+		gl_Position.x = gl_Position.x * 0.5 + side * 0.5 * gl_Position.w;
+	}
+}
+)";
+
+	inline const char *debug_fragment = R"(#version 150
+in vec4 v_color;
+out vec4 o_color;
+void main() {
+	o_color = v_color;
+}
+)";
+} // namespace polar::support::gl32::shaders
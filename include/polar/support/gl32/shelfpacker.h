@@ -0,0 +1,60 @@
+#pragma once
+
+#include <optional>
+#include <polar/math/point.h>
+#include <vector>
+
+namespace polar::support::gl32 {
+	/* packs rectangles into rows ("shelves") of a fixed size atlas
+	 *
+	 * each rectangle goes on the shelf wasting the least height, a new shelf is
+	 * opened below the last one when none fit
+	 */
+	class shelfpacker {
+		struct shelf {
+			int y;
+			int height;
+			int x = 0;
+		};
+
+		int width;
+		int height;
+		int padding;
+		std::vector<shelf> shelves;
+
+	  public:
+		shelfpacker(int width, int height, int padding = 1) : width(width), height(height), padding(padding) {}
+
+		inline int getwidth() const { return width; }
+		inline int getheight() const { return height; }
+
+		inline void clear() { shelves.clear(); }
+
+		// bottom of the last shelf, the height actually in use
+		inline int used() const { return shelves.empty() ? 0 : shelves.back().y + shelves.back().height; }
+
+		std::optional<math::point2i> pack(int w, int h) {
+			int pw = w + padding;
+			int ph = h + padding;
+			if(pw > width) { return std::nullopt; }
+
+			shelf *best = nullptr;
+			for(auto &s : shelves) {
+				if(s.height >= ph && width - s.x >= pw) {
+					if(best == nullptr || s.height < best->height) { best = &s; }
+				}
+			}
+
+			if(best == nullptr) {
+				int y = used();
+				if(y + ph > height) { return std::nullopt; }
+				shelves.emplace_back(shelf{y, ph});
+				best = &shelves.back();
+			}
+
+			math::point2i pos(best->x, best->y);
+			best->x += pw;
+			return pos;
+		}
+	};
+} // namespace polar::support::gl32
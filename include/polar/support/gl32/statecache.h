@@ -0,0 +1,188 @@
+#pragma once
+
+#include <array>
+#include <polar/util/gl.h>
+
+namespace polar::support::gl32 {
+	/* shadows the GL state the renderer changes most often so that redundant
+	 * binds never reach the driver
+	 *
+	 * anything binding behind its back (other libraries, deleted objects whose
+	 * names may be reused) must be followed by invalidate()
+	 */
+	class statecache {
+	  public:
+		static const size_t max_units    = 32;
+		static const size_t max_bindings = 8;
+
+		struct counters {
+			size_t issued  = 0;
+			size_t skipped = 0;
+		};
+
+	  private:
+		static const GLuint unknown = GLuint(-1);
+
+		enum class tristate : uint8_t { unknown, off, on };
+
+		GLuint program    = unknown;
+		GLuint vao        = unknown;
+		GLuint fbo        = unknown;
+		GLuint activeUnit = unknown;
+		std::array<GLuint, max_units> textures;
+		std::array<GLuint, max_bindings> ubos;
+
+		tristate depthTest    = tristate::unknown;
+		tristate blend        = tristate::unknown;
+		tristate cullFace     = tristate::unknown;
+		tristate clipDistance = tristate::unknown;
+		GLenum blendSrc       = GL_NONE;
+		GLenum blendDst       = GL_NONE;
+
+		counters current;
+		counters last;
+
+		inline bool changed(bool differs) {
+			if(differs) {
+				++current.issued;
+			} else {
+				++current.skipped;
+			}
+			return differs;
+		}
+
+		inline tristate *capability(GLenum cap) {
+			switch(cap) {
+			case GL_DEPTH_TEST:
+				return &depthTest;
+			case GL_BLEND:
+				return &blend;
+			case GL_CULL_FACE:
+				return &cullFace;
+			case GL_CLIP_DISTANCE0:
+				return &clipDistance;
+			default:
+				return nullptr;
+			}
+		}
+
+	  public:
+		statecache() { invalidate(); }
+
+		void invalidate() {
+			program    = unknown;
+			vao        = unknown;
+			fbo        = unknown;
+			activeUnit = unknown;
+			textures.fill(unknown);
+			ubos.fill(unknown);
+
+			depthTest    = tristate::unknown;
+			blend        = tristate::unknown;
+			cullFace     = tristate::unknown;
+			clipDistance = tristate::unknown;
+			blendSrc     = GL_NONE;
+			blendDst     = GL_NONE;
+		}
+
+		// counters of the last completed frame
+		inline const counters &frame() const { return last; }
+
+		inline void endframe() {
+			last    = current;
+			current = counters();
+		}
+
+		inline void useprogram(GLuint p) {
+			if(changed(p != program)) {
+				GL(glUseProgram(p));
+				program = p;
+			}
+		}
+
+		inline void bindvao(GLuint v) {
+			if(changed(v != vao)) {
+				GL(glBindVertexArray(v));
+				vao = v;
+			}
+		}
+
+		inline void bindfbo(GLuint f) {
+			if(changed(f != fbo)) {
+				GL(glBindFramebuffer(GL_FRAMEBUFFER, f));
+				fbo = f;
+			}
+		}
+
+		inline void activetexture(GLuint unit) {
+			if(changed(unit != activeUnit)) {
+				GL(glActiveTexture(GL_TEXTURE0 + unit));
+				activeUnit = unit;
+			}
+		}
+
+		// binds to the active unit, used while uploading textures
+		inline void bindtexture(GLuint tex) {
+			if(activeUnit >= max_units) { activetexture(0); }
+			if(changed(tex != textures[activeUnit])) {
+				GL(glBindTexture(GL_TEXTURE_2D, tex));
+				textures[activeUnit] = tex;
+			}
+		}
+
+		inline void bindtexture(GLuint unit, GLuint tex) {
+			if(unit >= max_units) {
+				GL(glActiveTexture(GL_TEXTURE0 + unit));
+				GL(glBindTexture(GL_TEXTURE_2D, tex));
+				activeUnit = unknown;
+				current.issued += 2;
+				return;
+			}
+
+			// only switch units when the texture actually changes
+			if(changed(tex != textures[unit])) {
+				activetexture(unit);
+				GL(glBindTexture(GL_TEXTURE_2D, tex));
+				textures[unit] = tex;
+			}
+		}
+
+		inline void bindubo(GLuint binding, GLuint buffer) {
+			if(binding >= max_bindings) {
+				++current.issued;
+				GL(glBindBufferBase(GL_UNIFORM_BUFFER, binding, buffer));
+			} else if(changed(buffer != ubos[binding])) {
+				GL(glBindBufferBase(GL_UNIFORM_BUFFER, binding, buffer));
+				ubos[binding] = buffer;
+			}
+		}
+
+		inline void enable(GLenum cap, bool on) {
+			auto state = capability(cap);
+			auto want  = on ? tristate::on : tristate::off;
+			if(state == nullptr) {
+				++current.issued;
+				if(on) {
+					GL(glEnable(cap));
+				} else {
+					GL(glDisable(cap));
+				}
+			} else if(changed(*state != want)) {
+				if(on) {
+					GL(glEnable(cap));
+				} else {
+					GL(glDisable(cap));
+				}
+				*state = want;
+			}
+		}
+
+		inline void blendfunc(GLenum src, GLenum dst) {
+			if(changed(src != blendSrc || dst != blendDst)) {
+				GL(glBlendFunc(src, dst));
+				blendSrc = src;
+				blendDst = dst;
+			}
+		}
+	};
+} // namespace polar::support::gl32
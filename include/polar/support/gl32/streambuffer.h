@@ -0,0 +1,164 @@
+#pragma once
+
+#include <array>
+#include <polar/util/gl.h>
+#include <vector>
+
+namespace polar::support::gl32 {
+	/* ring of GPU memory for data written once and drawn within the same frame
+	 *
+	 * the buffer is split into one region per frame in flight, a frame writes
+	 * linearly into its region and fences it when done so the region is only
+	 * written again once the GPU has finished reading it
+	 *
+	 * with ARB_buffer_storage the buffer stays persistently mapped, otherwise
+	 * every allocation maps its own range unsynchronized, and without ARB_sync
+	 * the storage is orphaned at the start of every frame instead of fenced
+	 */
+	class streambuffer {
+	  public:
+		static const size_t frames = 3;
+
+		struct allocation {
+			void *ptr;
+			GLintptr offset;
+		};
+
+	  private:
+		GLuint buffer         = 0;
+		GLsizeiptr regionSize = 0;
+		GLsizeiptr head       = 0;
+		size_t region         = 0;
+		bool persistent       = false;
+		bool fenced           = false;
+		bool writing          = false;
+		char *mapped          = nullptr;
+		std::array<GLsync, frames> fences{};
+		std::vector<GLuint> retired;
+
+		void create(GLsizeiptr size) {
+			regionSize = size;
+			auto total = regionSize * GLsizeiptr(frames);
+
+			GL(glGenBuffers(1, &buffer));
+			GL(glBindBuffer(GL_ARRAY_BUFFER, buffer));
+			if(persistent) {
+				GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+				GL(glBufferStorage(GL_ARRAY_BUFFER, total, NULL, flags));
+				GL(mapped = static_cast<char *>(glMapBufferRange(GL_ARRAY_BUFFER, 0, total, flags)));
+			} else {
+				GL(glBufferData(GL_ARRAY_BUFFER, total, NULL, GL_STREAM_DRAW));
+			}
+		}
+
+		void destroy() {
+			for(auto &fence : fences) {
+				if(fence) {
+					GL(glDeleteSync(fence));
+					fence = nullptr;
+				}
+			}
+
+			if(mapped != nullptr) {
+				GL(glBindBuffer(GL_ARRAY_BUFFER, buffer));
+				GL(glUnmapBuffer(GL_ARRAY_BUFFER));
+				mapped = nullptr;
+			}
+
+			// offsets handed out this frame still refer to the old name
+			retired.emplace_back(buffer);
+			buffer = 0;
+		}
+
+		void wait(GLsync fence) {
+			GLenum result = GL_TIMEOUT_EXPIRED;
+			while(result == GL_TIMEOUT_EXPIRED) {
+				GL(result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000));
+			}
+		}
+
+	  public:
+		void init(GLsizeiptr size) {
+			fenced     = GLEW_VERSION_3_2 || GLEW_ARB_sync;
+			persistent = fenced && GLEW_ARB_buffer_storage;
+			create(size);
+
+			if(persistent) {
+				log()->verbose("gl", "streaming through persistently mapped buffer");
+			} else if(fenced) {
+				log()->verbose("gl", "streaming through unsynchronized buffer mappings");
+			} else {
+				log()->verbose("gl", "ARB_sync unsupported, orphaning stream buffer every frame");
+			}
+		}
+
+		inline GLuint name() const { return buffer; }
+
+		// writable memory for the given bytes, its offset into name() is a multiple of align
+		allocation map(GLsizeiptr bytes, GLsizeiptr align) {
+			unmap();
+
+			GLintptr base   = GLintptr(region) * regionSize;
+			GLintptr offset = (base + head + align - 1) / align * align - base;
+			if(offset + bytes > regionSize) {
+				// outgrew the region, start over in a larger buffer rather than stall
+				auto size = regionSize * 2;
+				while(size < bytes + align) { size *= 2; }
+				log()->debug("gl", "growing stream buffer to ", size * GLsizeiptr(frames), " bytes");
+
+				destroy();
+				create(size);
+				region = 0;
+				base   = 0;
+				offset = 0;
+			}
+			head = offset + bytes;
+
+			GLintptr at = base + offset;
+			if(persistent) { return allocation{mapped + at, at}; }
+
+			GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+			void *ptr;
+			GL(glBindBuffer(GL_ARRAY_BUFFER, buffer));
+			GL(ptr = glMapBufferRange(GL_ARRAY_BUFFER, at, bytes, flags));
+			writing = true;
+			return allocation{ptr, at};
+		}
+
+		// has to follow the last map() before anything draws from it
+		void unmap() {
+			if(!writing) { return; }
+
+			GL(glBindBuffer(GL_ARRAY_BUFFER, buffer));
+			GL(glUnmapBuffer(GL_ARRAY_BUFFER));
+			writing = false;
+		}
+
+		void endframe() {
+			unmap();
+
+			// draws still reading retired storage keep it alive in the driver
+			if(!retired.empty()) {
+				GL(glDeleteBuffers(GLsizei(retired.size()), retired.data()));
+				retired.clear();
+			}
+
+			if(fenced) { GL(fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0)); }
+
+			region = (region + 1) % frames;
+			head   = 0;
+
+			if(fenced) {
+				// long signalled unless the GPU has fallen a whole ring behind
+				if(fences[region]) {
+					wait(fences[region]);
+					GL(glDeleteSync(fences[region]));
+					fences[region] = nullptr;
+				}
+			} else {
+				GL(glBindBuffer(GL_ARRAY_BUFFER, buffer));
+				GL(glBufferData(GL_ARRAY_BUFFER, regionSize * GLsizeiptr(frames), NULL, GL_STREAM_DRAW));
+			}
+		}
+	};
+} // namespace polar::support::gl32
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <polar/asset/image.h>
+#include <polar/support/gl32/statecache.h>
+#include <polar/util/gl.h>
+
+namespace polar::support::gl32 {
+	/* fills textures from images without stalling the frame that asked for them
+	 *
+	 * a queued image is copied into a mapped pixel buffer on a worker thread,
+	 * once the copy has landed the texture is specified from that buffer and
+	 * its mips generated, spending at most a byte budget per frame
+	 *
+	 * textures show a 1x1 white placeholder until their pixels arrive
+	 */
+	class textureuploader {
+		struct upload {
+			GLuint texture;
+			std::shared_ptr<polar::asset::image> image;
+			GLuint pbo = 0;
+			std::shared_ptr<std::atomic<bool>> staged;
+			bool cancelled = false;
+			bool finished  = false;
+
+			inline size_t bytes() const { return image->pixels.size() * sizeof(polar::asset::imagepixel); }
+		};
+
+		std::deque<upload> uploads;
+		size_t inFlight = 0;
+		size_t uploaded = 0;
+
+		// false when no pixel buffer could be mapped
+		template<typename Dispatch> bool stage(upload &up, Dispatch &dispatch) {
+			auto bytes = up.bytes();
+
+			GL(glGenBuffers(1, &up.pbo));
+			GL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, up.pbo));
+			GL(glBufferData(GL_PIXEL_UNPACK_BUFFER, GLsizeiptr(bytes), NULL, GL_STREAM_DRAW));
+
+			void *ptr;
+			GL(ptr = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, GLsizeiptr(bytes),
+			                          GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+			GL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+
+			if(ptr == nullptr) {
+				GL(glDeleteBuffers(1, &up.pbo));
+				up.pbo = 0;
+				return false;
+			}
+
+			up.staged->store(false);
+			inFlight += bytes;
+
+			auto image  = up.image;
+			auto staged = up.staged;
+			dispatch([ptr, image, staged, bytes] {
+				std::memcpy(ptr, image->pixels.data(), bytes);
+				staged->store(true);
+			});
+			return true;
+		}
+
+		// specifies the texture straight from the image, stalling until the driver has copied it
+		void direct(statecache &state, upload &up) {
+			state.bindtexture(up.texture);
+			GL(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, GLsizei(up.image->width), GLsizei(up.image->height), 0,
+			                GL_RGBA, GL_UNSIGNED_BYTE, up.image->pixels.data()));
+			GL(glGenerateMipmap(GL_TEXTURE_2D));
+
+			up.finished = true;
+			++uploaded;
+		}
+
+		// false when the pixel buffer lost its contents and has to be staged again
+		bool finish(statecache &state, upload &up) {
+			GLboolean intact;
+			GL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, up.pbo));
+			GL(intact = glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER));
+
+			if(intact && !up.cancelled) {
+				state.bindtexture(up.texture);
+				GL(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, GLsizei(up.image->width), GLsizei(up.image->height), 0,
+				                GL_RGBA, GL_UNSIGNED_BYTE, NULL));
+				GL(glGenerateMipmap(GL_TEXTURE_2D));
+			}
+
+			GL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+			GL(glDeleteBuffers(1, &up.pbo));
+			up.pbo    = 0;
+			inFlight -= up.bytes();
+
+			return intact || up.cancelled;
+		}
+
+	  public:
+		// the texture must be bound to the current unit
+		static void placeholder() {
+			static const uint32_t white = 0xffffffff;
+			GL(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, &white));
+		}
+
+		void queue(GLuint texture, std::shared_ptr<polar::asset::image> image) {
+			uploads.emplace_back(upload{texture, image, 0, std::make_shared<std::atomic<bool>>(false)});
+		}
+
+		// called before the texture is deleted, its name may be reused for something else
+		void cancel(GLuint texture) {
+			for(auto &up : uploads) {
+				if(up.texture == texture) { up.cancelled = true; }
+			}
+		}
+
+		/* finishes landed uploads oldest first within budget bytes, then stages
+		 * more images while no more than a few frames' worth are in flight
+		 *
+		 * dispatch(fn) runs fn on another thread, or inline when there is none
+		 */
+		template<typename Dispatch> void update(statecache &state, size_t budget, Dispatch dispatch) {
+			size_t spent = 0;
+			while(!uploads.empty()) {
+				auto &up = uploads.front();
+
+				if(up.pbo == 0) {
+					if(!up.cancelled && !up.finished) { break; }
+					uploads.pop_front();
+					continue;
+				}
+
+				// one upload always goes through so large images cannot starve
+				if(!up.staged->load()) { break; }
+				if(!up.cancelled && spent > 0 && spent + up.bytes() > budget) { break; }
+
+				if(!up.cancelled) { spent += up.bytes(); }
+				if(finish(state, up)) {
+					if(!up.cancelled) { ++uploaded; }
+					uploads.pop_front();
+				} else {
+					log()->debug("gl", "pixel buffer contents lost, staging texture ", up.texture, " again");
+				}
+			}
+
+			for(auto &up : uploads) {
+				if(up.pbo != 0 || up.cancelled || up.finished) { continue; }
+				if(inFlight > 0 && inFlight + up.bytes() > budget * 4) { break; }
+				if(!stage(up, dispatch)) {
+					log()->debug("gl", "failed to map pixel buffer, uploading texture ", up.texture, " directly");
+					direct(state, up);
+				}
+			}
+		}
+
+		inline size_t pending() const { return uploads.size(); }
+		inline size_t completed() const { return uploaded; }
+	};
+} // namespace polar::support::gl32
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <array>
+#include <polar/math/types.h>
+#include <polar/util/gl.h>
+#include <string>
+#include <unordered_map>
+
+namespace polar::support::gl32 {
+	// uniforms set by the renderer itself, resolved once per program when it is linked
+	enum class uniform : uint8_t {
+		projection,
+		view,
+		invViewProj,
+		model,
+		resolution,
+		ditherTex,
+		ambient,
+		diffuse,
+		specular,
+		specular_exponent,
+		diffuse_map,
+		specular_map,
+		normal_map,
+		texture,
+		color,
+		transform,
+		colorBuffer,
+		instances,
+		renderScale,
+		count
+	};
+
+	inline const char *uniformname(uniform u) {
+		static const char *names[] = {
+			"u_projection",
+			"u_view",
+			"u_invViewProj",
+			"u_model",
+			"u_resolution",
+			"u_ditherTex",
+			"u_ambient",
+			"u_diffuse",
+			"u_specular",
+			"u_specular_exponent",
+			"u_diffuse_map",
+			"u_specular_map",
+			"u_normal_map",
+			"u_texture",
+			"u_color",
+			"u_transform",
+			"u_colorBuffer",
+			"polar_instances",
+			"u_renderScale"
+		};
+		static_assert(sizeof(names) / sizeof(*names) == size_t(uniform::count), "missing uniform name");
+		return names[size_t(u)];
+	}
+
+	// std140 uniform blocks emitted by the shader converter, the value is the binding point
+	enum class uniformblock : GLuint {
+		frame    = 0,
+		material = 1
+	};
+
+	inline const char *blockname(uniformblock b) {
+		switch(b) {
+		case uniformblock::frame:
+			return "polar_frame";
+		case uniformblock::material:
+			return "polar_material";
+		}
+		return "";
+	}
+
+	/* std140 layout of polar_frame, one set of matrices per view where the
+	 * second is only read by single-pass stereo
+	 *
+	 * stereo.x is the number of views side by side, stereo.y the width of one
+	 */
+	struct frameblock {
+		glm::mat4 projection[2];
+		glm::mat4 view[2];
+		glm::mat4 invViewProj[2];
+		glm::vec4 stereo;
+	};
+
+	// std140 layout of polar_material, each vec3 is padded to 16 bytes
+	struct materialblock {
+		glm::vec3 ambient;
+		float pad0 = 0;
+		glm::vec3 diffuse;
+		float pad1 = 0;
+		glm::vec3 specular;
+		float specular_exponent;
+	};
+
+	struct uniformcache {
+		std::array<GLint, size_t(uniform::count)> locations;
+
+		// program specific uniforms declared by the shader asset
+		std::unordered_map<std::string, GLint> named;
+
+		bool frameBlock    = false;
+		bool materialBlock = false;
+
+		uniformcache() { locations.fill(-1); }
+
+		inline GLint operator[](uniform u) const { return locations[size_t(u)]; }
+
+		inline GLint find(const std::string &name) const {
+			auto it = named.find(name);
+			return it != named.cend() ? it->second : -1;
+		}
+	};
+} // namespace polar::support::gl32
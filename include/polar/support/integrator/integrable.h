@@ -3,6 +3,8 @@
 #include <memory>
 #include <optional>
 #include <boost/circular_buffer.hpp>
+#include <cstring>
+#include <functional>
 #include <polar/core/deltaticks.h>
 
 namespace polar::support::integrator {
@@ -38,6 +40,15 @@ namespace polar::support::integrator {
 		ease_towards
 	};
 
+	// inherit defers to the scheme passed down by system::integrator
+	enum class scheme {
+		inherit,
+		polynomial,
+		semi_implicit_euler,
+		velocity_verlet,
+		rk4
+	};
+
 	template<typename T> struct target_t {
 		target_type type;
 		T value;
@@ -49,12 +60,23 @@ namespace polar::support::integrator {
 		virtual ~integrable_base() {}
 		virtual bool hasderivative(const unsigned char = 0)             = 0;
 		virtual integrable_base &getderivative(const unsigned char = 0) = 0;
-		virtual void integrate(const DeltaTicks::seconds_type)          = 0;
+		virtual void integrate(const DeltaTicks::seconds_type,
+		                       const scheme = scheme::inherit)          = 0;
 		virtual bool revert_by(size_t = 0)                              = 0;
 		virtual bool revert_to(size_t = 0)                              = 0;
+
+		// value, target and derivative chain laid out flat for system::snapshot
+		virtual size_t snapshot_size() const                            = 0;
+		virtual void snapshot(uint8_t *&) const                         = 0;
+		virtual void restore(const uint8_t *&)                          = 0;
 	};
 
 	template<typename T, class D = T> class integrable : public integrable_base {
+		template<typename, class> friend class integrable;
+
+	  public:
+		using acceleration_fn = std::function<D(const T &, const D &)>;
+
 	  private:
 		using derivative_t = std::unique_ptr<integrable<D>>;
 
@@ -67,6 +89,97 @@ namespace polar::support::integrator {
 		derivative_t deriv;
 		std::optional<target_t<T>> _target;
 
+		scheme _scheme = scheme::inherit;
+		acceleration_fn _acceleration;
+
+		static inline D scaled(const D &d, const math::decimal factor) {
+			return integrable_interp<D>(integrable_id<D>(), d, factor);
+		}
+
+		inline D acceleration(const T &x, const D &v) {
+			if(_acceleration) {
+				return _acceleration(x, v);
+			} else if(hasderivative(1)) {
+				return *derivative(1);
+			} else {
+				return integrable_id<D>();
+			}
+		}
+
+		inline void ease() {
+			if(_target) {
+				switch(_target->type) {
+				case target_type::ease_towards:
+					value = integrable_interp(value, _target->value, _target->factor);
+					break;
+				}
+			}
+		}
+
+		// step to a value computed by the integrable above, keeping the rest of the chain in sync
+		inline void advance(const T &next, const DeltaTicks::seconds_type seconds, const scheme s) {
+			history.push_back({value, _target});
+			value = next;
+			if(deriv) { deriv->integrate(seconds, s); }
+			ease();
+		}
+
+		inline void integrate_polynomial(const DeltaTicks::seconds_type seconds, const scheme s) {
+			D delta = integrable_interp<D>(integrable_id<D>(), *derivative(), seconds);
+			value = integrable_sum(value, delta);
+
+			// if second-order derivative exists, integrate polynomially
+			if(hasderivative(1)) {
+				D delta = integrable_interp<D>(integrable_id<D>(), *derivative(1), seconds * seconds / math::decimal(2));
+				value = integrable_sum(value, delta);
+			}
+
+			derivative().integrate(seconds, s);
+		}
+
+		inline void integrate_semi_implicit_euler(const DeltaTicks::seconds_type seconds, const scheme s) {
+			auto &vel = derivative();
+			if(_acceleration) { vel.derivative().value = _acceleration(value, *vel); }
+
+			// update velocity first and advance position with the new velocity
+			vel.integrate(seconds, s);
+			value = integrable_sum(value, scaled(*vel, seconds));
+		}
+
+		inline void integrate_velocity_verlet(const DeltaTicks::seconds_type seconds, const scheme s) {
+			auto &vel = derivative();
+			D v  = *vel;
+			D a0 = acceleration(value, v);
+
+			value = integrable_sum(value, integrable_sum(scaled(v, seconds), scaled(a0, seconds * seconds / math::decimal(2))));
+
+			D a1 = acceleration(value, v);
+			vel.advance(integrable_sum(v, scaled(integrable_sum(a0, a1), seconds / math::decimal(2))), seconds, s);
+		}
+
+		inline void integrate_rk4(const DeltaTicks::seconds_type seconds, const scheme s) {
+			auto &vel   = derivative();
+			auto half   = seconds / math::decimal(2);
+			auto sixth  = seconds / math::decimal(6);
+			const T x   = value;
+			const D v   = *vel;
+
+			D k1x = v;
+			D k1v = acceleration(x, k1x);
+			D k2x = integrable_sum(v, scaled(k1v, half));
+			D k2v = acceleration(integrable_sum(x, scaled(k1x, half)), k2x);
+			D k3x = integrable_sum(v, scaled(k2v, half));
+			D k3v = acceleration(integrable_sum(x, scaled(k2x, half)), k3x);
+			D k4x = integrable_sum(v, scaled(k3v, seconds));
+			D k4v = acceleration(integrable_sum(x, scaled(k3x, seconds)), k4x);
+
+			D dx = integrable_sum(integrable_sum(k1x, scaled(k2x, 2)), integrable_sum(scaled(k3x, 2), k4x));
+			D dv = integrable_sum(integrable_sum(k1v, scaled(k2v, 2)), integrable_sum(scaled(k3v, 2), k4v));
+
+			value = integrable_sum(x, scaled(dx, sixth));
+			vel.advance(integrable_sum(v, scaled(dv, sixth)), seconds, s);
+		}
+
 	  public:
 		boost::circular_buffer<history_entry> history;
 
@@ -84,6 +197,12 @@ namespace polar::support::integrator {
 			return _target;
 		}
 
+		inline void setscheme(scheme s) { _scheme = s; }
+		inline scheme getscheme() const { return _scheme; }
+
+		// acceleration as a function of value and velocity, used by verlet and rk4 in place of the second derivative
+		inline void setacceleration(acceleration_fn fn) { _acceleration = fn; }
+
 		inline operator const T &() const { return get(); }
 
 		inline const T &get() const { return value; }
@@ -140,36 +259,35 @@ namespace polar::support::integrator {
 		inline T temporal(const math::decimal seconds) {
 			if(hasderivative()) {
 				D delta = integrable_interp<D>(integrable_id<D>(), derivative().temporal(seconds), seconds);
-				integrable<T> ret(integrable_sum(value, delta));
 				return integrable_sum(value, delta);
 			} else {
 				return *this;
 			}
 		}
 
-		inline void integrate(const DeltaTicks::seconds_type seconds) override {
+		inline void integrate(const DeltaTicks::seconds_type seconds, const scheme fallback = scheme::inherit) override {
 			history.push_back({value, _target});
 
 			if(hasderivative()) {
-				D delta = integrable_interp<D>(integrable_id<D>(), *derivative(), seconds);
-				value = integrable_sum(value, delta);
-
-				// if second-order derivative exists, integrate polynomially
-				if(hasderivative(1)) {
-					D delta = integrable_interp<D>(integrable_id<D>(), *derivative(1), seconds * seconds / math::decimal(2));
-					value = integrable_sum(value, delta);
-				}
-
-				derivative().integrate(seconds);
-			}
-
-			if(_target) {
-				switch(_target->type) {
-				case target_type::ease_towards:
-					value = integrable_interp(value, _target->value, _target->factor);
+				auto s = _scheme == scheme::inherit ? fallback : _scheme;
+				switch(s) {
+				case scheme::inherit:
+				case scheme::polynomial:
+					integrate_polynomial(seconds, s);
+					break;
+				case scheme::semi_implicit_euler:
+					integrate_semi_implicit_euler(seconds, s);
+					break;
+				case scheme::velocity_verlet:
+					integrate_velocity_verlet(seconds, s);
+					break;
+				case scheme::rk4:
+					integrate_rk4(seconds, s);
 					break;
 				}
 			}
+
+			ease();
 		}
 
 		inline bool revert_by(size_t n = 1) override {
@@ -197,6 +315,47 @@ namespace polar::support::integrator {
 			}
 		}
 
+		inline size_t snapshot_size() const override {
+			size_t size = sizeof(T) + 2;
+			if(_target) { size += sizeof(target_t<T>); }
+			if(deriv) { size += deriv->snapshot_size(); }
+			return size;
+		}
+
+		inline void snapshot(uint8_t *&dst) const override {
+			std::memcpy(dst, &value, sizeof(T));
+			dst += sizeof(T);
+
+			*dst++ = _target ? 1 : 0;
+			if(_target) {
+				std::memcpy(dst, &*_target, sizeof(target_t<T>));
+				dst += sizeof(target_t<T>);
+			}
+
+			*dst++ = deriv ? 1 : 0;
+			if(deriv) { deriv->snapshot(dst); }
+		}
+
+		inline void restore(const uint8_t *&src) override {
+			std::memcpy(&value, src, sizeof(T));
+			src += sizeof(T);
+
+			if(*src++) {
+				target_t<T> t;
+				std::memcpy(&t, src, sizeof(target_t<T>));
+				src += sizeof(target_t<T>);
+				_target = t;
+			} else {
+				_target.reset();
+			}
+
+			if(*src++) {
+				derivative().restore(src);
+			} else {
+				deriv.reset();
+			}
+		}
+
 		inline T &operator*() { return value; }
 		inline T *operator->() { return &value; }
 
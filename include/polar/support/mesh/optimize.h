@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+#include <polar/asset/vertex.h>
+#include <vector>
+
+namespace polar::support::mesh {
+	// merge bitwise identical vertices of a triangle soup into an indexed mesh
+	void weld(const std::vector<polar::asset::vertex> &soup, std::vector<polar::asset::vertex> &vertices,
+	          std::vector<uint32_t> &indices);
+
+	// reorder triangles for the post-transform vertex cache (Tom Forsyth's linear-speed algorithm)
+	void optimize_cache(std::vector<uint32_t> &indices, size_t vertexCount);
+
+	// reorder vertices by first use so fetches walk the vertex buffer linearly
+	void optimize_fetch(std::vector<polar::asset::vertex> &vertices, std::vector<uint32_t> &indices);
+
+	// average cache miss ratio, vertex transforms per triangle through a FIFO cache
+	float acmr(const std::vector<uint32_t> &indices, size_t cacheSize = 32);
+} // namespace polar::support::mesh
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <polar/asset/packedvertex.h>
+#include <polar/asset/vertex.h>
+#include <vector>
+
+namespace polar::support::mesh {
+	uint16_t tohalf(float f);
+	float fromhalf(uint16_t h);
+
+	uint32_t packnormal(const math::point3 &n);
+	math::point3 unpacknormal(uint32_t packed);
+
+	// axis aligned bounds plus the radius of a sphere around their center
+	void bounds(const std::vector<polar::asset::vertex> &vertices, math::point3 &lo, math::point3 &hi, float &radius);
+
+	/* positions are quantized inside a cube around the mesh bounds so that
+	 * the dequantization is a uniform scale and leaves normals untouched
+	 */
+	void quantize(const std::vector<polar::asset::vertex> &vertices, std::vector<polar::asset::packedvertex> &packed,
+	              math::point3 &center, float &extent);
+
+	void dequantize(const std::vector<polar::asset::packedvertex> &packed, const math::point3 &center, float extent,
+	                std::vector<polar::asset::vertex> &vertices);
+
+	// fill in missing normals by accumulating the normals of every face sharing a vertex
+	void generate_normals(std::vector<polar::asset::vertex> &vertices, const std::vector<uint32_t> &indices);
+} // namespace polar::support::mesh
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+#include <polar/asset/vertex.h>
+#include <vector>
+
+namespace polar::support::mesh {
+	/* quadric error edge collapse towards targetIndexCount indices, stopping
+	 * early rather than moving the surface further than maxError
+	 *
+	 * vertices are collapsed onto each other so the result indexes the same
+	 * vertex buffer, open borders and attribute seams stay where they are
+	 *
+	 * resultError receives the error reached, in the units of the positions
+	 */
+	std::vector<uint32_t> simplify(const std::vector<polar::asset::vertex> &vertices,
+	                               const std::vector<uint32_t> &indices, size_t targetIndexCount, float maxError,
+	                               float *resultError = nullptr);
+} // namespace polar::support::mesh
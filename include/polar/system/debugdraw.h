@@ -0,0 +1,174 @@
+#pragma once
+
+#include <algorithm>
+#include <polar/system/base.h>
+#include <polar/util/atomic.h>
+#include <vector>
+
+namespace polar::system {
+	/* debug geometry which any system may submit from any thread, the
+	 * renderer draws everything alive with one instanced draw per primitive
+	 * type
+	 *
+	 * a primitive without a duration is drawn by the next frame only, one with
+	 * a duration stays up for that many seconds, so that something submitted
+	 * at a lower rate than frames are rendered, like every simulation tick,
+	 * can last until it is submitted again
+	 */
+	class debugdraw : public base {
+	  public:
+		// unit cube or ball under transform
+		struct shape {
+			math::mat4x4 transform;
+			math::point4 color;
+			math::decimal until = 0;
+		};
+
+		// streamed as is, the renderer skips until through the vertex stride
+		struct vertex {
+			math::point3 position;
+			math::point4 color;
+			math::decimal until = 0;
+		};
+
+		struct batch {
+			std::vector<shape> boxes;
+			std::vector<shape> balls;
+			std::vector<vertex> lines; // two vertices per line
+			std::vector<vertex> points;
+
+			inline bool empty() const { return boxes.empty() && balls.empty() && lines.empty() && points.empty(); }
+
+			inline void clear() {
+				boxes.clear();
+				balls.clear();
+				lines.clear();
+				points.clear();
+			}
+		};
+
+	  private:
+		struct store {
+			batch primitives;
+			math::decimal now      = 0;
+			math::decimal previous = 0;
+		};
+
+		atomic<store> pending;
+		bool enabled = true;
+
+		template<typename T>
+		static void append(std::vector<T> &to, const std::vector<T> &from, math::decimal now) {
+			for(auto p : from) {
+				p.until += now;
+				to.emplace_back(p);
+			}
+		}
+
+		// drops what expired at or before time, lines go in pairs since both ends share until
+		static void prune(batch &b, math::decimal time) {
+			auto expired = [time] (const auto &p) { return p.until <= time; };
+			b.boxes.erase(std::remove_if(b.boxes.begin(), b.boxes.end(), expired), b.boxes.end());
+			b.balls.erase(std::remove_if(b.balls.begin(), b.balls.end(), expired), b.balls.end());
+			b.lines.erase(std::remove_if(b.lines.begin(), b.lines.end(), expired), b.lines.end());
+			b.points.erase(std::remove_if(b.points.begin(), b.points.end(), expired), b.points.end());
+		}
+
+	  protected:
+		/* without a renderer taking them, primitives without a duration are
+		 * dropped a frame after being submitted, so the batch cannot grow
+		 * however long nothing draws it
+		 */
+		void update(DeltaTicks &dt) override {
+			pending.with([&dt] (store &s) {
+				prune(s.primitives, s.previous);
+				s.previous = s.now;
+				s.now     += math::decimal(dt.Seconds());
+			});
+		}
+
+	  public:
+		static bool supported() { return true; }
+		debugdraw(core::polar *engine) : base(engine) {}
+
+		virtual std::string name() const override { return "debugdraw"; }
+
+		virtual accessor_list accessors() const override {
+			accessor_list l;
+			l.emplace_back("enabled", make_accessor<debugdraw>(
+				[] (debugdraw *ptr) {
+					return ptr->enabled;
+				},
+				[] (debugdraw *ptr, auto x) {
+					ptr->enabled = x ? true : false;
+				}
+			));
+			return l;
+		}
+
+		// submitters can skip gathering anything while nothing will be drawn
+		inline bool active() const { return enabled; }
+
+		void box(const math::mat4x4 &transform, const math::point4 &color = math::point4(1),
+		         math::decimal duration = 0) {
+			if(!enabled) { return; }
+			pending.with([&transform, &color, duration] (store &s) {
+				s.primitives.boxes.emplace_back(shape{transform, color, s.now + duration});
+			});
+		}
+
+		void box(const math::point3 &center, const math::point3 &halfExtents,
+		         const math::point4 &color = math::point4(1), math::decimal duration = 0) {
+			box(glm::scale(glm::translate(math::mat4x4(1), center), halfExtents), color, duration);
+		}
+
+		void ball(const math::mat4x4 &transform, const math::point4 &color = math::point4(1),
+		          math::decimal duration = 0) {
+			if(!enabled) { return; }
+			pending.with([&transform, &color, duration] (store &s) {
+				s.primitives.balls.emplace_back(shape{transform, color, s.now + duration});
+			});
+		}
+
+		void ball(const math::point3 &center, math::decimal radius, const math::point4 &color = math::point4(1),
+		          math::decimal duration = 0) {
+			ball(glm::scale(glm::translate(math::mat4x4(1), center), math::point3(radius)), color, duration);
+		}
+
+		void line(const math::point3 &from, const math::point3 &to, const math::point4 &color = math::point4(1),
+		          math::decimal duration = 0) {
+			if(!enabled) { return; }
+			pending.with([&from, &to, &color, duration] (store &s) {
+				s.primitives.lines.emplace_back(vertex{from, color, s.now + duration});
+				s.primitives.lines.emplace_back(vertex{to, color, s.now + duration});
+			});
+		}
+
+		void point(const math::point3 &position, const math::point4 &color = math::point4(1),
+		           math::decimal duration = 0) {
+			if(!enabled) { return; }
+			pending.with([&position, &color, duration] (store &s) {
+				s.primitives.points.emplace_back(vertex{position, color, s.now + duration});
+			});
+		}
+
+		// many primitives under a single lock, their until is taken as a duration
+		void submit(const batch &primitives) {
+			if(!enabled) { return; }
+			pending.with([&primitives] (store &s) {
+				append(s.primitives.boxes, primitives.boxes, s.now);
+				append(s.primitives.balls, primitives.balls, s.now);
+				append(s.primitives.lines, primitives.lines, s.now);
+				append(s.primitives.points, primitives.points, s.now);
+			});
+		}
+
+		// copies everything alive into into, then drops what was only meant for this frame
+		void take(batch &into) {
+			pending.with([&into] (store &s) {
+				into = s.primitives;
+				prune(s.primitives, s.now);
+			});
+		}
+	};
+} // namespace polar::system
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <limits>
+#include <polar/component/orientation.h>
+#include <polar/component/parent.h>
+#include <polar/component/position.h>
+#include <polar/component/scale.h>
+#include <polar/system/base.h>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace polar::system {
+	class hierarchy : public base {
+	  public:
+		static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+		struct node {
+			core::weak_ref object;
+			size_t parent = npos;
+
+			component::position *pos       = nullptr;
+			component::orientation *orient = nullptr;
+			component::scale *sc           = nullptr;
+
+			// local TRS the matrices were last built from
+			math::point3 translation = math::point3(0);
+			math::quat rotation      = math::quat(1, 0, 0, 0);
+			math::point3 scaling     = math::point3(1);
+
+			math::mat4x4 local = math::mat4x4(1);
+			math::mat4x4 world = math::mat4x4(1);
+
+			bool dirty   = true;
+			bool changed = true;
+		};
+
+	  private:
+		// breadth-first so every parent precedes its children and one linear pass suffices
+		std::vector<node> nodes;
+		std::unordered_map<core::id, size_t> indices;
+		bool structure_dirty = true;
+
+		size_t last_recomputed = 0;
+
+		void rebuild();
+		void push(core::weak_ref, size_t);
+
+	  protected:
+		void component_added(core::weak_ref, std::type_index ti, std::weak_ptr<component::base>) override {
+			if(ti == typeid(component::parent) || ti == typeid(component::position) ||
+			   ti == typeid(component::orientation) || ti == typeid(component::scale)) {
+				structure_dirty = true;
+			}
+		}
+
+		void component_removed(core::weak_ref, std::type_index ti) override {
+			if(ti == typeid(component::parent) || ti == typeid(component::position) ||
+			   ti == typeid(component::orientation) || ti == typeid(component::scale)) {
+				structure_dirty = true;
+			}
+		}
+
+	  public:
+		static bool supported() { return true; }
+		hierarchy(core::polar *engine) : base(engine) {}
+
+		virtual std::string name() const override { return "hierarchy"; }
+
+		virtual accessor_list accessors() const override {
+			accessor_list l;
+			l.emplace_back("nodes", make_accessor<hierarchy>(
+				[] (hierarchy *ptr) {
+					return ptr->nodes.size();
+				},
+				[] (hierarchy *, auto) {}
+			));
+			l.emplace_back("recomputed", make_accessor<hierarchy>(
+				[] (hierarchy *ptr) {
+					return ptr->last_recomputed;
+				},
+				[] (hierarchy *, auto) {}
+			));
+			return l;
+		}
+
+		// interpolate local transforms and refresh world matrices of changed subtrees only
+		void propagate(math::decimal delta);
+
+		inline const node *find(core::weak_ref object) const {
+			auto it = indices.find(object.id());
+			return it != indices.end() ? &nodes[it->second] : nullptr;
+		}
+
+		inline const math::mat4x4 *world(core::weak_ref object) const {
+			auto n = find(object);
+			return n ? &n->world : nullptr;
+		}
+	};
+} // namespace polar::system
@@ -9,6 +9,9 @@
 
 namespace polar::system {
 	class integrator : public base {
+	  public:
+		using scheme = support::integrator::scheme;
+
 	  private:
 		DeltaTicks accumulator;
 		void tick(DeltaTicks::seconds_type);
@@ -25,6 +28,9 @@ namespace polar::system {
 			});
 		}
 	  public:
+		// used by integrables which do not select their own scheme
+		scheme default_scheme = scheme::polynomial;
+
 		static bool supported() { return true; }
 		integrator(core::polar *engine) : base(engine) {}
 
@@ -43,6 +49,15 @@ namespace polar::system {
 				}
 			));
 			*/
+			l.emplace_back("scheme", make_accessor<integrator>(
+				[] (integrator *ptr) {
+					return math::decimal(ptr->default_scheme);
+				},
+				[] (integrator *ptr, auto x) {
+					auto s = scheme(int(x));
+					if(s > scheme::inherit && s <= scheme::rk4) { ptr->default_scheme = s; }
+				}
+			));
 			return l;
 		}
 
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <polar/system/vr.h>
+
+namespace polar::system {
+	/* headset stand-in with fixed eye projections and an identity head pose,
+	 * added with add_as<system::vr, system::mockvr>() it drives the stereo
+	 * paths of the renderer without OpenVR or any hardware
+	 */
+	class mockvr : public vr {
+	  private:
+		math::decimal fovy;
+		size_t submitted = 0;
+
+	  public:
+		static bool supported() { return true; }
+
+		mockvr(core::polar *engine, uint32_t width = 1080, uint32_t height = 1200,
+		       math::decimal fovy = glm::radians(math::decimal(100)))
+		    : vr(engine, headless_t{}), fovy(fovy) {
+			_width  = width;
+			_height = height;
+			_ready  = true;
+
+			log()->verbose("vr", "using mock headset (width=", width, ", height=", height, ')');
+		}
+
+		void update(DeltaTicks &) override {}
+
+		void update_poses() override {
+			_last_head_view       = _head_view;
+			_last_left_hand_view  = _left_hand_view;
+			_last_right_hand_view = _right_hand_view;
+		}
+
+		// asymmetric like a real headset, each eye sees further towards its own side
+		math::mat4x4 projection(eye e, math::decimal zNear, math::decimal zFar) const override {
+			auto top   = zNear * glm::tan(fovy / 2);
+			auto right = top * math::decimal(_width) / math::decimal(_height);
+			auto inner = right * math::decimal(0.8);
+			auto outer = right * math::decimal(1.2);
+
+			if(e == eye::left) {
+				return glm::frustum(-outer, inner, -top, top, zNear, zFar);
+			} else {
+				return glm::frustum(-inner, outer, -top, top, zNear, zFar);
+			}
+		}
+
+		bool submit_gl(eye, uintptr_t tex, float uMin = 0, float uMax = 1) override {
+			++submitted;
+			return tex != 0 && uMin < uMax;
+		}
+
+		inline size_t submissions() const { return submitted; }
+
+		// a headset that is not ready is ignored by the renderer, as if it was taken off
+		inline void setready(bool ready) { _ready = ready; }
+	};
+} // namespace polar::system
@@ -5,6 +5,8 @@
 #include <unordered_map>
 
 namespace polar::system {
+	class debugdraw;
+
 	class phys : public base {
 	  private:
 		template<typename T> struct pair_hasher {
@@ -50,6 +52,9 @@ namespace polar::system {
 
 		void tick(DeltaTicks);
 
+		// overlapping pairs show up through system::debugdraw until the next tick replaces them
+		void debugcontact(debugdraw &, core::weak_ref, core::weak_ref, math::decimal duration);
+
 	  protected:
 		void init() override;
 
@@ -3,16 +3,32 @@
 #include <array>
 #include <boost/container/flat_set.hpp>
 #include <functional>
+#include <map>
 #include <polar/asset/font.h>
 #include <polar/asset/shaderprogram.h>
+#include <polar/component/color.h>
 #include <polar/component/model.h>
+#include <polar/component/orientation.h>
 #include <polar/component/phys.h>
+#include <polar/component/position.h>
+#include <polar/component/scale.h>
 #include <polar/component/sprite/base.h>
 #include <polar/component/text.h>
 #include <polar/property/gl32/model.h>
 #include <polar/property/gl32/sprite.h>
+#include <polar/property/gl32/text.h>
+#include <polar/support/gl32/drawqueue.h>
 #include <polar/support/gl32/fontcache.h>
+#include <polar/support/gl32/gpuprofiler.h>
+#include <polar/support/gl32/hiz.h>
 #include <polar/support/gl32/pipelinenode.h>
+#include <polar/support/gl32/programcache.h>
+#include <polar/support/gl32/refcache.h>
+#include <polar/support/gl32/shelfpacker.h>
+#include <polar/support/gl32/statecache.h>
+#include <polar/support/gl32/streambuffer.h>
+#include <polar/support/gl32/textureuploader.h>
+#include <polar/system/debugdraw.h>
 #include <polar/system/renderer/base.h>
 #include <polar/util/gl.h>
 #include <polar/util/sdl.h>
@@ -23,9 +39,47 @@
 namespace polar::system::renderer {
 	class gl32 : public base {
 		using pipelinenode = support::gl32::pipelinenode;
+		using drawqueue    = support::gl32::drawqueue;
+		using uniform      = support::gl32::uniform;
+		using uniformblock = support::gl32::uniformblock;
+		using uniformcache = support::gl32::uniformcache;
 		using fontcache_t  = support::gl32::fontcache;
 		using model_p      = property::gl32::model;
 		using sprite_p     = property::gl32::sprite;
+		using text_p       = property::gl32::text;
+
+		// everything a pass needs to draw a model, gathered once per rendered frame
+		struct drawentry {
+			core::weak_ref object;
+			component::model *model        = nullptr;
+			model_p *property              = nullptr;
+			component::position *pos       = nullptr;
+			component::orientation *orient = nullptr;
+			component::scale *sc           = nullptr;
+			component::phys *phys          = nullptr;
+			component::color *col          = nullptr;
+			const math::mat4x4 *world      = nullptr;
+			size_t lod                     = 0;
+		};
+
+		// per-instance vertex data, matches a_instanceModel and a_instanceColor
+		struct instancedata {
+			math::mat4x4 model;
+			math::point4 color;
+		};
+
+		// screen space vertex of the batched UI programs
+		struct batchvertex {
+			glm::vec4 position;
+			glm::vec2 texcoord;
+			glm::vec4 color;
+		};
+
+		// run of queued instances sharing one model asset
+		struct drawgroup {
+			size_t first;
+			GLsizei count;
+		};
 
 	  private:
 		bool inited     = false;
@@ -35,9 +89,23 @@ namespace polar::system::renderer {
 		SDL_Window *window = nullptr;
 		SDL_GLContext context;
 
+		support::gl32::statecache state;
+
 		std::vector<std::string> pipelineNames;
 		std::vector<pipelinenode> nodes;
-		std::unordered_multiset<std::shared_ptr<model_p>> modelPropertyPool;
+		std::vector<std::shared_ptr<polar::asset::shaderprogram>> pipelineAssets;
+
+		// linked programs survive restarts, so only a changed shader or driver relinks
+		support::gl32::programcache programs;
+
+		// views side by side in the render targets, two with single-pass stereo
+		bool singlePassStereo = true;
+		size_t views          = 1;
+
+		// pipeline nodes and the passes after them are timed on the GPU, read back a few frames late
+		support::gl32::gpuprofiler gpu;
+		// released model buffers ordered by vertex buffer capacity
+		std::multimap<GLsizeiptr, std::shared_ptr<model_p>> modelPropertyPool;
 		std::unordered_map<std::shared_ptr<polar::asset::font>, fontcache_t>
 		    fontCache;
 
@@ -49,12 +117,127 @@ namespace polar::system::renderer {
 		GLuint debug_box_vao;
 		GLuint debug_ball_vao;
 
-		GLuint spriteProgram;
+		// primitives from system::debugdraw and the colliders of debug_draw, streamed once per frame
+		system::debugdraw::batch debugBatch;
+		GLuint debugLineVAO        = 0;
+		GLuint debugBuffer         = 0;
+		GLintptr debugShapeOffset  = 0;
+		GLintptr debugVertexOffset = 0;
+
+		// debug shapes are filled unless outlined, which leaves the models inside them visible
+		bool debugOutlines = false;
+
 		GLuint identityProgram;
 		GLuint debugProgram;
 		GLuint ditherTex;
 
+		// per-frame instance data and UI batches are written into one ring buffer
+		support::gl32::streambuffer stream;
+
+		// every text sharing a font is drawn with one call from the stream
+		GLuint batchProgram;
+		GLuint batchVAO;
+		GLuint batchBuffer = 0;
+		uniformcache batchLocations;
+		std::unordered_map<std::shared_ptr<polar::asset::font>, std::vector<batchvertex>> textBatches;
+
+		// UI sprites share one atlas and are drawn with a single call
+		GLuint spriteAtlas = 0;
+		GLint maxAtlasSize = 4096;
+		support::gl32::shelfpacker spritePacker{1024, 1024};
+		std::unordered_set<component::sprite::base *> atlasSprites;
+		std::vector<batchvertex> spriteBatch;
+
+		uniformcache identityLocations;
+		uniformcache debugLocations;
+
+		// frame block is shared by every program, material blocks are shared by every model using the material
+		GLuint frameUBO;
+
+		// GPU resources shared between components, released with their last user
+		support::gl32::refcache<const polar::asset::model *, std::shared_ptr<model_p>> meshCache;
+		support::gl32::refcache<std::string, GLuint> textureCache;
+		support::gl32::refcache<std::string, GLuint> materialCache;
+
+		// image pixels reach their textures over several frames instead of in acquiretexture
+		support::gl32::textureuploader textureUploads;
+		size_t textureBudget = 4 << 20;
+
+		// retained overlay, created once and updated in place
 		core::ref fps_object;
+		std::shared_ptr<component::text> fpsText;
+
+		static const size_t frameGraphSize = 120;
+		std::array<math::decimal, frameGraphSize> frameTimes{};
+		size_t frameTimeHead = 0;
+		bool showFrameGraph  = false;
+		GLuint whiteTex;
+		std::vector<batchvertex> overlayVertices;
+
+		std::vector<drawentry> drawentries;
+		std::vector<math::mat4x4> transforms;
+		std::vector<math::mat4x4> debugtransforms;
+		std::vector<math::point4> colors;
+
+		// draw order of drawentries, sorted by state
+		drawqueue queue;
+		support::gl32::keyids meshIds;
+		support::gl32::keyids materialIds;
+
+		// key ids of cached materials, held as long as materialCache holds the block
+		std::unordered_map<std::string, uint32_t> materialKeyIds;
+
+		// world space bounding spheres of drawentries, kept apart so the frustum test vectorizes
+		std::vector<float> cullX, cullY, cullZ, cullR;
+		std::vector<uint8_t> visible;
+		size_t culledCount = 0;
+
+		// model draw calls issued last frame, both eyes together when stereo renders twice
+		size_t modelDraws = 0;
+
+		/* a model draws its coarsest level of detail whose error covers no more
+		 * than lodPixelError pixels, it only coarsens once that error is below
+		 * lodHysteresis of the threshold so instances near it do not flicker
+		 */
+		float lodPixelError = 1;
+		float lodHysteresis = 0.75f;
+
+		// previous frames' depth reduced on the GPU and read back through PBOs for occlusion culling
+		static const size_t hizSlots = 2;
+		static const int hizWidth    = 256;
+		bool occlusion               = true;
+		size_t occludedCount         = 0;
+		GLuint hizProgram            = 0;
+		uniformcache hizLocations;
+		GLuint hizFBO = 0;
+		GLuint hizTex = 0;
+		int hizHeight = 0;
+		std::array<GLuint, hizSlots> hizPBOs{};
+		std::array<bool, hizSlots> hizPending{};
+		std::array<GLsync, hizSlots> hizFences{};
+		std::array<math::mat4x4, hizSlots> hizViewProj;
+		size_t hizSlot = 0;
+		support::gl32::hizbuffer hiz;
+
+		/* dynamic resolution renders the pipeline into the corner of its full
+		 * size targets, shrinking it while its passes take longer on the GPU
+		 * than the target frame time, and stretches the result over the window
+		 */
+		bool dynamicResolution = true;
+		bool scalable          = false;
+		float renderScale      = 1;
+		float minRenderScale   = 0.5f;
+		float targetFrameMs    = 15;
+		GLuint upscaleProgram  = 0;
+		uniformcache upscaleLocations;
+
+		// compact models need signed 2_10_10_10 normals, otherwise they are expanded on upload
+		bool packedNormals = false;
+
+		bool instancing = false;
+		GLuint instanceBuffer   = 0;
+		GLintptr instanceOffset = 0;
+		std::vector<drawgroup> drawgroups;
 
 		std::unordered_map<std::string, glm::uint32> uniformsU32;
 		std::unordered_map<std::string, math::decimal> uniformsFloat;
@@ -68,28 +251,264 @@ namespace polar::system::renderer {
 		void update(DeltaTicks &) override;
 		void rendersprite(core::weak_ref, math::mat4x4 = math::mat4x4(1), math::mat4x4 view = math::mat4x4(1));
 		void rendertext(core::weak_ref, math::mat4x4 proj = math::mat4x4(1), math::mat4x4 view = math::mat4x4(1));
-		void render(math::mat4x4 proj, math::mat4x4 view, float delta);
+		void cachefont(const std::shared_ptr<polar::asset::font> &);
+		void buildtext(const component::text &, text_p &, math::decimal offsetY);
+		void drawbatch(GLuint texture, const std::vector<batchvertex> &);
+		void bindbatch();
+		void addsprite(component::sprite::base &, sprite_p &, bool grow = true);
+		bool placesprite(component::sprite::base &, sprite_p &);
+		void repackatlas(int size);
+		void updateoverlay(DeltaTicks &);
+		void drawframegraph();
+		void prepare(float delta, const math::mat4x4 &view, const math::mat4x4 &proj);
+		void prepareinstances();
+		void preparedebug();
+		void drawdebug(GLsizei eyes);
+		void makehiz();
+		void capturehiz(const math::mat4x4 &viewProj);
+		void collecthiz();
+		void bindinstances(const pipelinenode &, size_t first);
+		void bindmaterial(const pipelinenode &, const drawentry &, std::array<unsigned int, 3> texPos);
+		void render(const std::array<math::mat4x4, 2> &projs, math::mat4x4 view);
+
+		inline void render(math::mat4x4 proj, math::mat4x4 view) { render({proj, proj}, view); }
+
+		// buffer sizes are rounded up to powers of two so pooled buffers fit many meshes
+		static inline GLsizeiptr sizeclass(GLsizeiptr bytes) {
+			if(bytes <= 0) { return 0; }
+			GLsizeiptr c = 4096;
+			while(c < bytes) { c <<= 1; }
+			return c;
+		}
 
-		std::shared_ptr<model_p> getpooledmodelproperty(const GLsizei required);
+		std::shared_ptr<model_p> getpooledmodelproperty(GLsizeiptr vertexBytes, GLsizeiptr indexBytes);
 
+		void setvertexlayout(model_p &, bool compact);
 		void uploadmodel(std::shared_ptr<component::model> model);
+		std::pair<std::shared_ptr<model_p>, size_t> makemesh(std::shared_ptr<component::model> model);
+		void releasemodel(component::model &model);
+		GLuint acquiretexture(const std::string &name);
 
 		void component_added(core::weak_ref, std::type_index, std::weak_ptr<component::base>) override;
 		void component_removed(core::weak_ref, std::type_index) override;
 
 		math::mat4x4 calculate_projection();
-		void project(GLuint programID, math::mat4x4 proj);
-		inline void project(GLuint programID) { project(programID, calculate_projection()); }
+		void project(GLuint programID, const uniformcache &, math::mat4x4 proj);
+		inline void project(GLuint programID, const uniformcache &locations) {
+			project(programID, locations, calculate_projection());
+		}
+		void uploadframe(const std::array<math::mat4x4, 2> &projs, math::mat4x4 view);
+		GLuint acquirematerial(const std::string &name);
 
 		void initGL();
 		void handleSDL(SDL_Event &);
 		void makepipeline(const std::vector<std::string> &) override;
+		void maketargets();
+		void droptargets();
+		size_t stereoviews();
+
+		inline GLsizei targetwidth() const { return GLsizei(width) * GLsizei(views); }
+		inline GLsizei scaledwidth() const { return std::max(GLsizei(1), GLsizei(targetwidth() * renderScale)); }
+		inline GLsizei scaledheight() const { return std::max(GLsizei(1), GLsizei(height * renderScale)); }
+
+		void updatescale();
+		void upscale();
 		GLuint makeprogram(std::shared_ptr<polar::asset::shaderprogram>);
+		uniformcache resolveuniforms(GLuint program, const std::vector<std::string> &names = {});
 
 	  public:
 		math::decimal fps = 60.0;
 
 		static bool supported();
+
+		virtual accessor_list accessors() const override {
+			accessor_list l = base::accessors();
+			l.emplace_back("showframegraph", make_accessor<gl32>(
+				[] (gl32 *ptr) {
+					return ptr->showFrameGraph;
+				},
+				[] (gl32 *ptr, auto x) {
+					ptr->showFrameGraph = x ? true : false;
+				}
+			));
+			l.emplace_back("frametime_ms", make_accessor<gl32>(
+				[] (gl32 *ptr) {
+					return ptr->frameTimes[(ptr->frameTimeHead + frameGraphSize - 1) % frameGraphSize];
+				},
+				[] (gl32 *, auto) {}
+			));
+			l.emplace_back("gl_issued", make_accessor<gl32>(
+				[] (gl32 *ptr) {
+					return ptr->state.frame().issued;
+				},
+				[] (gl32 *, auto) {}
+			));
+			l.emplace_back("gl_skipped", make_accessor<gl32>(
+				[] (gl32 *ptr) {
+					return ptr->state.frame().skipped;
+				},
+				[] (gl32 *, auto) {}
+			));
+			l.emplace_back("models_culled", make_accessor<gl32>(
+				[] (gl32 *ptr) {
+					return ptr->culledCount;
+				},
+				[] (gl32 *, auto) {}
+			));
+			l.emplace_back("model_draws", make_accessor<gl32>(
+				[] (gl32 *ptr) {
+					return ptr->modelDraws;
+				},
+				[] (gl32 *, auto) {}
+			));
+			l.emplace_back("resident_mesh_bytes", make_accessor<gl32>(
+				[] (gl32 *ptr) {
+					return ptr->meshCache.bytes();
+				},
+				[] (gl32 *, auto) {}
+			));
+			l.emplace_back("resident_texture_bytes", make_accessor<gl32>(
+				[] (gl32 *ptr) {
+					return ptr->textureCache.bytes();
+				},
+				[] (gl32 *, auto) {}
+			));
+			l.emplace_back("resident_material_bytes", make_accessor<gl32>(
+				[] (gl32 *ptr) {
+					return ptr->materialCache.bytes();
+				},
+				[] (gl32 *, auto) {}
+			));
+			l.emplace_back("pooled_mesh_bytes", make_accessor<gl32>(
+				[] (gl32 *ptr) {
+					size_t bytes = 0;
+					for(auto &pair : ptr->modelPropertyPool) { bytes += size_t(pair.first + pair.second->indexBytes); }
+					return bytes;
+				},
+				[] (gl32 *, auto) {}
+			));
+			l.emplace_back("texture_upload_budget", make_accessor<gl32>(
+				[] (gl32 *ptr) {
+					return ptr->textureBudget;
+				},
+				[] (gl32 *ptr, auto x) {
+					ptr->textureBudget = size_t(x);
+				}
+			));
+			l.emplace_back("textures_pending", make_accessor<gl32>(
+				[] (gl32 *ptr) {
+					return ptr->textureUploads.pending();
+				},
+				[] (gl32 *, auto) {}
+			));
+			l.emplace_back("gpu_profile", make_accessor<gl32>(
+				[] (gl32 *ptr) {
+					return ptr->gpu.getenabled();
+				},
+				[] (gl32 *ptr, auto x) {
+					ptr->gpu.setenabled(x ? true : false);
+				}
+			));
+			l.emplace_back("gpu_ms", make_accessor<gl32>(
+				[] (gl32 *ptr) {
+					return ptr->gpu.framems();
+				},
+				[] (gl32 *, auto) {}
+			));
+			for(auto &pass : pipelineNames) { l.emplace_back("gpu_ms_" + pass, gpuaccessor(pass)); }
+			for(auto pass : {"models", "sprites", "text", "mirror", "hiz"}) {
+				l.emplace_back(std::string("gpu_ms_") + pass, gpuaccessor(pass));
+			}
+			l.emplace_back("gpu_trace", make_accessor<gl32>(
+				[] (gl32 *ptr) {
+					return ptr->gpu.capturing();
+				},
+				[] (gl32 *ptr, auto x) {
+					// the trace opens in chrome://tracing or any viewer reading the Chrome trace format
+					ptr->gpu.capture(size_t(std::max(decltype(x)(0), x)), fs::local::app_dir() / "gputrace.json");
+				}
+			));
+			l.emplace_back("dynamic_resolution", make_accessor<gl32>(
+				[] (gl32 *ptr) {
+					return ptr->dynamicResolution;
+				},
+				[] (gl32 *ptr, auto x) {
+					ptr->dynamicResolution = x ? true : false;
+				}
+			));
+			l.emplace_back("render_scale", make_accessor<gl32>(
+				[] (gl32 *ptr) {
+					return ptr->renderScale;
+				},
+				[] (gl32 *, auto) {}
+			));
+			l.emplace_back("min_render_scale", make_accessor<gl32>(
+				[] (gl32 *ptr) {
+					return ptr->minRenderScale;
+				},
+				[] (gl32 *ptr, auto x) {
+					ptr->minRenderScale = std::clamp(float(x), 0.1f, 1.0f);
+				}
+			));
+			l.emplace_back("target_frame_ms", make_accessor<gl32>(
+				[] (gl32 *ptr) {
+					return ptr->targetFrameMs;
+				},
+				[] (gl32 *ptr, auto x) {
+					ptr->targetFrameMs = std::max(float(x), 1.0f);
+				}
+			));
+			l.emplace_back("stereo_single_pass", make_accessor<gl32>(
+				[] (gl32 *ptr) {
+					return ptr->singlePassStereo;
+				},
+				[] (gl32 *ptr, auto x) {
+					ptr->singlePassStereo = x ? true : false;
+				}
+			));
+			l.emplace_back("occlusion", make_accessor<gl32>(
+				[] (gl32 *ptr) {
+					return ptr->occlusion;
+				},
+				[] (gl32 *ptr, auto x) {
+					ptr->occlusion = x ? true : false;
+					if(!ptr->occlusion) { ptr->hiz.invalidate(); }
+				}
+			));
+			l.emplace_back("models_occluded", make_accessor<gl32>(
+				[] (gl32 *ptr) {
+					return ptr->occludedCount;
+				},
+				[] (gl32 *, auto) {}
+			));
+			l.emplace_back("debug_outlines", make_accessor<gl32>(
+				[] (gl32 *ptr) {
+					return ptr->debugOutlines;
+				},
+				[] (gl32 *ptr, auto x) {
+					ptr->debugOutlines = x ? true : false;
+				}
+			));
+			l.emplace_back("lod_pixel_error", make_accessor<gl32>(
+				[] (gl32 *ptr) {
+					return ptr->lodPixelError;
+				},
+				[] (gl32 *ptr, auto x) {
+					ptr->lodPixelError = std::max(0.0f, float(x));
+				}
+			));
+			return l;
+		}
+
+		static accessor_type gpuaccessor(const std::string &pass) {
+			return make_accessor<gl32>(
+				[pass] (gl32 *ptr) {
+					return ptr->gpu.ms(pass);
+				},
+				[] (gl32 *, auto) {}
+			);
+		}
+
 		gl32(core::polar *engine, const std::vector<std::string> &names)
 		    : base(engine) {
 			setpipeline(names);
@@ -106,8 +525,8 @@ namespace polar::system::renderer {
 
 		void rebuild() {
 			auto act = engine->get<action>().lock();
-			GL(glViewport(0, 0, width, height));
-			makepipeline(pipelineNames);
+			// programs do not depend on the size, only the render targets do
+			maketargets();
 			if(act) {
 				act->trigger<action_resize>();
 			}
@@ -137,5 +556,13 @@ namespace polar::system::renderer {
 		bool uploaduniform(GLuint program, const std::string &name, math::point3 p);
 		bool uploaduniform(GLuint program, const std::string &name, math::point4 p);
 		bool uploaduniform(GLuint program, const std::string &name, math::mat4x4 m);
+
+		bool uploaduniform(GLint loc, glm::int32 x);
+		bool uploaduniform(GLint loc, glm::uint32 x);
+		bool uploaduniform(GLint loc, math::decimal x);
+		bool uploaduniform(GLint loc, math::point2 p);
+		bool uploaduniform(GLint loc, math::point3 p);
+		bool uploaduniform(GLint loc, math::point4 p);
+		bool uploaduniform(GLint loc, math::mat4x4 m);
 	};
 } // namespace polar::system::renderer
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <polar/component/clock/simulation.h>
+#include <polar/component/listener.h>
+#include <polar/support/integrator/integrable.h>
+#include <polar/tag/clock/simulation.h>
+#include <vector>
+
+namespace polar::system {
+	/* every simulation tick the values of all integrables, such as positions
+	 * and orientations, are copied into a ring of byte buffers alongside the
+	 * set of component relations, which is only recaptured when it changes
+	 *
+	 * only integrable values are serialized, every other component is put
+	 * back by pointer with whatever state it has now rather than its state at
+	 * that tick, so this is not a whole world snapshot: physics responders,
+	 * action state and the like are not rolled back with it
+	 *
+	 * every frame's layout holds a pointer to every component in the world,
+	 * so components removed after a structural change, along with their
+	 * renderer and physics properties, stay alive until the last frame that
+	 * saw them is overwritten up to capacity ticks later, their destructors
+	 * and any side effects of releasing them are delayed by as much
+	 */
+	class snapshot : public base {
+	  private:
+		using integrable_base = support::integrator::integrable_base;
+
+		// relations and integrables captured together so the integrable pointers stay valid
+		struct layout {
+			std::vector<core::relation> relations;
+			std::vector<integrable_base *> integrables;
+		};
+
+		struct frame {
+			uint64_t tick = 0;
+			std::shared_ptr<const layout> world;
+			std::vector<uint8_t> bytes;
+		};
+
+		core::ref clock;
+
+		// ring of frames reused in place so steady state saves do not allocate
+		std::vector<frame> frames;
+		size_t head  = 0;
+		size_t count = 0;
+
+		uint64_t ticks = 0;
+
+		std::shared_ptr<const layout> current;
+		bool dirty     = true;
+		bool restoring = false;
+
+		size_t last_bytes       = 0;
+		size_t last_relations   = 0;
+		math::decimal save_us    = 0;
+		math::decimal restore_us = 0;
+
+		void tick();
+		void restore(const frame &);
+		void rebuild();
+
+		inline frame &at(size_t n) { return frames[(head + frames.size() - 1 - n) % frames.size()]; }
+
+	  protected:
+		void init() override {
+			clock = engine->own<tag::clock::simulation>();
+			engine->add_as<component::clock::base, component::clock::simulation>(clock);
+
+			core::ref listener;
+			keep(listener = engine->add());
+			engine->add<component::listener>(listener, clock, [this](auto) {
+				tick();
+			});
+		}
+
+		void component_added(core::weak_ref, std::type_index, std::weak_ptr<component::base>) override {
+			if(!restoring) { dirty = true; }
+		}
+
+		void component_removed(core::weak_ref, std::type_index) override {
+			if(!restoring) { dirty = true; }
+		}
+
+	  public:
+		static bool supported() { return true; }
+		snapshot(core::polar *engine, size_t capacity = 100) : base(engine), frames(capacity) {}
+
+		virtual std::string name() const override { return "snapshot"; }
+
+		virtual accessor_list accessors() const override {
+			accessor_list l;
+			l.emplace_back("capacity", make_accessor<snapshot>(
+				[] (snapshot *ptr) {
+					return ptr->capacity();
+				},
+				[] (snapshot *ptr, auto x) {
+					ptr->setcapacity(size_t(x));
+				}
+			));
+			l.emplace_back("bytes", make_accessor<snapshot>(
+				[] (snapshot *ptr) {
+					return ptr->last_bytes;
+				},
+				[] (snapshot *, auto) {}
+			));
+			l.emplace_back("relations", make_accessor<snapshot>(
+				[] (snapshot *ptr) {
+					return ptr->last_relations;
+				},
+				[] (snapshot *, auto) {}
+			));
+			l.emplace_back("save_us", make_accessor<snapshot>(
+				[] (snapshot *ptr) {
+					return ptr->save_us;
+				},
+				[] (snapshot *, auto) {}
+			));
+			l.emplace_back("restore_us", make_accessor<snapshot>(
+				[] (snapshot *ptr) {
+					return ptr->restore_us;
+				},
+				[] (snapshot *, auto) {}
+			));
+			return l;
+		}
+
+		inline size_t capacity() const { return frames.size(); }
+		inline size_t available() const { return count; }
+		inline uint64_t tick_count() const { return ticks; }
+
+		void setcapacity(size_t);
+
+		// capture the present as the newest frame, done on every simulation tick
+		void save();
+
+		inline size_t bytes() const { return last_bytes; }
+
+		// restore the world as it was n ticks ago without re-simulating
+		bool restore_by(size_t n = 0);
+
+		// restore the world n ticks ago, rewind actions and re-simulate back to the present
+		bool rollback(size_t n = 1);
+	};
+} // namespace polar::system
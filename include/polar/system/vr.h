@@ -12,13 +12,9 @@ namespace polar::system {
 	 *      for other HMDs such as HTC Vive
 	 */
 	class vr : public base {
-	private:
+	protected:
 		using eye = support::vr::eye;
 
-		::vr::IVRSystem *vr_system = nullptr;
-		std::unordered_set<::vr::TrackedDeviceIndex_t> tracked_devices;
-		std::vector<std::string> render_models_loading;
-
 		bool _ready = false;
 		uint32_t _width = 0;
 		uint32_t _height = 0;
@@ -31,6 +27,15 @@ namespace polar::system {
 		math::mat4x4 _last_left_hand_view = math::mat4x4(1);
 		math::mat4x4 _last_right_hand_view = math::mat4x4(1);
 
+		// for stand-ins that supply their own poses without touching OpenVR
+		struct headless_t {};
+		vr(core::polar *engine, headless_t) : base(engine) {}
+
+	private:
+		::vr::IVRSystem *vr_system = nullptr;
+		std::unordered_set<::vr::TrackedDeviceIndex_t> tracked_devices;
+		std::vector<std::string> render_models_loading;
+
 		std::string tracked_device_str(::vr::TrackedDeviceIndex_t i, ::vr::TrackedDeviceProperty p) {
 			::vr::TrackedPropertyError err;
 			auto len = vr_system->GetStringTrackedDeviceProperty(i, p, nullptr, 0, &err);
@@ -168,10 +173,10 @@ namespace polar::system {
 		}
 
 		~vr() {
-			if(ready()) { ::vr::VR_Shutdown(); }
+			if(vr_system != nullptr) { ::vr::VR_Shutdown(); }
 		}
 
-		void update(DeltaTicks &) {
+		void update(DeltaTicks &) override {
 			if(!ready()) { return; }
 
 			load_render_models();
@@ -261,7 +266,7 @@ namespace polar::system {
 			}
 		}
 
-		void update_poses() {
+		virtual void update_poses() {
 			auto vr_comp = ::vr::VRCompositor();
 			if(ready() && vr_comp) {
 				::vr::TrackedDevicePose_t poses[::vr::k_unMaxTrackedDeviceCount];
@@ -280,7 +285,7 @@ namespace polar::system {
 			}
 		}
 
-		math::mat4x4 projection(eye e, math::decimal zNear, math::decimal zFar) const {
+		virtual math::mat4x4 projection(eye e, math::decimal zNear, math::decimal zFar) const {
 			if(!ready()) { return math::mat4x4(1); }
 
 			auto vr_eye = (e == eye::left) ? ::vr::Eye_Left : ::vr::Eye_Right;
@@ -288,14 +293,16 @@ namespace polar::system {
 			return glm::transpose(glm::make_mat4(&vr_proj.m[0][0]));
 		}
 
-		bool submit_gl(eye e, uintptr_t tex) {
+		// uMin and uMax select the part of the texture holding this eye
+		virtual bool submit_gl(eye e, uintptr_t tex, float uMin = 0, float uMax = 1) {
 			auto vr_comp = ::vr::VRCompositor();
 			if(!(ready() && vr_comp)) { return false; }
 
 			auto vr_eye = (e == eye::left) ? ::vr::Eye_Left : ::vr::Eye_Right;
 			::vr::Texture_t vr_tex = {(void *)tex, ::vr::TextureType_OpenGL, ::vr::ColorSpace_Gamma};
+			::vr::VRTextureBounds_t vr_bounds = {uMin, 0, uMax, 1};
 
-			auto err = vr_comp->Submit(vr_eye, &vr_tex);
+			auto err = vr_comp->Submit(vr_eye, &vr_tex, &vr_bounds);
 			if(err) {
 				log()->critical("vr", "failed to submit texture to VR compositor (", err, ')');
 				return false;
@@ -15,6 +15,9 @@ namespace polar::system {
 		using job_thread   = support::work::job_thread;
 		using job_type     = support::work::job_type;
 
+	  public:
+		using range_fn = std::function<void(size_t, size_t)>;
+
 	  private:
 		atomic<job_queue_t> jobs;
 		std::vector<worker_t *> _workers;
@@ -40,5 +43,9 @@ namespace polar::system {
 				             std::move(thread));
 			});
 		}
+
+		// split [0, count) into chunks of grain handed straight to the workers
+		// and to the calling thread, returning once every chunk has run
+		void parallel_for(size_t count, const range_fn &fn, size_t grain = 64);
 	};
 } // namespace polar::system
@@ -11,22 +11,21 @@ template<typename T> class atomic {
   private:
 	T value;
 	mutex_type mutex;
-	std::condition_variable cv;
+	std::condition_variable_any cv;
 
   public:
 	template<typename... Ts>
 	atomic(Ts &&... args) : value(std::forward<Ts>(args)...) {}
 
 	inline void notify() { cv.notify_one(); }
+	inline void notify_all() { cv.notify_all(); }
 
-	inline void wait(const std::function<bool(T &)> &,
-	                 const std::function<void(T &)> &) {
-		polar::log()->fatal("atomic", "wait: not implemented");
-		/*std::unique_lock<std::mutex> lock(mutex);
-		while(!pred(value)) {
-		    cv.wait(lock);
-		}
-		fn(value);*/
+	// block until pred holds then call fn while still holding the lock
+	inline void wait(const std::function<bool(T &)> &pred,
+	                 const std::function<void(T &)> &fn) {
+		std::unique_lock<mutex_type> lock(mutex);
+		cv.wait(lock, [this, &pred] { return pred(value); });
+		fn(value);
 	}
 
 	inline void with(const std::function<void(T &)> &fn) {
@@ -17,9 +17,13 @@
 #include <polar/asset/model.h>
 #include <polar/asset/shaderprogram.h>
 #include <polar/asset/text.h>
+#include <polar/asset/triangle.h>
 #include <polar/core/log.h>
 #include <polar/core/deltaticks.h>
 #include <polar/fs/local.h>
+#include <polar/support/mesh/optimize.h>
+#include <polar/support/mesh/quantize.h>
+#include <polar/support/mesh/simplify.h>
 #include <polar/util/debug.h>
 #include <polar/util/endian.h>
 #include <polar/util/getline.h>
@@ -28,8 +32,24 @@
 int main(int argc, char **argv) {
 	using namespace polar;
 
-	auto path       = (argc >= 2) ? core::path(argv[1]) : fs::local::app_dir() / "assets";
-	auto build_path = (argc >= 3) ? core::path(argv[2]) : path / "build";
+	// --compact-vertices stores models with quantized 16 byte vertices
+	bool compactVertices = false;
+	// --lod-levels <n> caps the simplified levels of detail built per model, 0 disables them
+	size_t lodLevels = 4;
+	std::vector<std::string> args;
+	for(int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		if(arg == "--compact-vertices") {
+			compactVertices = true;
+		} else if(arg == "--lod-levels" && i + 1 < argc) {
+			lodLevels = size_t(std::stoul(argv[++i]));
+		} else {
+			args.emplace_back(arg);
+		}
+	}
+
+	auto path       = (args.size() >= 1) ? core::path(args[0]) : fs::local::app_dir() / "assets";
+	auto build_path = (args.size() >= 2) ? core::path(args[1]) : path / "build";
 	auto files = fs::local::list_dir(path);
 
 	std::unordered_map<
@@ -475,12 +495,20 @@ int main(int argc, char **argv) {
 		s << asset;
 		return asset::name<asset::audio>();
 	};
-	converters["obj"] = [](const std::string &data, core::serializer &s) {
+	converters["obj"] = [compactVertices, lodLevels](const std::string &data, core::serializer &s) {
 		asset::model asset;
 		std::vector<math::point3> positions;
 		std::vector<math::point3> normals;
 		std::vector<math::point2> texcoords;
 
+		// faces are collected as a triangle soup and welded once the whole file is read
+		std::vector<asset::vertex> soup;
+		auto emit = [&soup](const asset::triangle &triangle) {
+			soup.emplace_back(triangle.p);
+			soup.emplace_back(triangle.q);
+			soup.emplace_back(triangle.r);
+		};
+
 		std::istringstream iss(data);
 		std::string line;
 		for(int iLine = 1; getline(iss, line); ++iLine) {
@@ -547,7 +575,7 @@ int main(int argc, char **argv) {
 				rs >> r_n;
 				triangle.r.normal = normals[r_n - 1];
 
-				asset.triangles.emplace_back(triangle);
+				emit(triangle);
 
 				while(ls.good()) {
 					std::string sstr;
@@ -570,7 +598,7 @@ int main(int argc, char **argv) {
 					ss >> s_n;
 					triangle.r.normal = normals[s_n - 1];
 
-					asset.triangles.emplace_back(triangle);
+					emit(triangle);
 				}
 			} else if(directive == "f") {
 				std::string pstr, qstr, rstr;
@@ -610,7 +638,7 @@ int main(int argc, char **argv) {
 					triangle.r.texcoord = texcoords[r - 1];
 				}
 
-				asset.triangles.emplace_back(triangle);
+				emit(triangle);
 
 				while(ls.good()) {
 					std::string sstr;
@@ -631,7 +659,7 @@ int main(int argc, char **argv) {
 						triangle.r.texcoord = texcoords[s - 1];
 					}
 
-					asset.triangles.emplace_back(triangle);
+					emit(triangle);
 				}
 			} else if(directive == "mtllib") {
 				std::string mat;
@@ -644,6 +672,48 @@ int main(int argc, char **argv) {
 			}
 		}
 
+		support::mesh::weld(soup, asset.vertices, asset.indices);
+		auto acmrBefore = support::mesh::acmr(asset.indices);
+
+		support::mesh::optimize_cache(asset.indices, asset.vertices.size());
+		support::mesh::optimize_fetch(asset.vertices, asset.indices);
+		auto acmrAfter = support::mesh::acmr(asset.indices);
+
+		log()->info("assetbuilder::obj", "vertices: ", soup.size(), " -> ", asset.vertices.size(),
+		            ", triangles: ", asset.indices.size() / 3, ", ACMR: ", acmrBefore, " -> ", acmrAfter);
+
+		support::mesh::bounds(asset.vertices, asset.boundsMin, asset.boundsMax, asset.radius);
+
+		/* every level aims for half the triangles of the one before, always
+		 * simplifying the full mesh so that errors are measured against it,
+		 * and the chain ends once the error limit stops a level from shrinking
+		 */
+		auto previous = asset.indices.size();
+		for(size_t level = 1; level <= lodLevels && asset.radius > 0; ++level) {
+			auto target = (asset.indices.size() >> level) / 3 * 3;
+			if(target < 3) { break; }
+
+			float error = 0;
+			auto lod    = support::mesh::simplify(asset.vertices, asset.indices, target, asset.radius * 0.25f, &error);
+			if(lod.empty() || lod.size() > previous * 3 / 4) { break; }
+
+			support::mesh::optimize_cache(lod, asset.vertices.size());
+			log()->info("assetbuilder::obj", "LOD ", level, ": triangles: ", lod.size() / 3, ", error: ", error);
+
+			previous = lod.size();
+			asset.lods.emplace_back(asset::modellod{std::move(lod), error});
+		}
+
+		if(compactVertices) {
+			// normals have to exist before they can be packed
+			support::mesh::generate_normals(asset.vertices, asset.indices);
+			support::mesh::quantize(asset.vertices, asset.packed, asset.center, asset.extent);
+
+			log()->info("assetbuilder::obj", "compact vertices: ", asset.vertices.size() * sizeof(asset::vertex),
+			            " -> ", asset.packed.size() * sizeof(asset::packedvertex), " bytes");
+			asset.vertices.clear();
+		}
+
 		s << asset;
 		return asset::name<asset::model>();
 	};
@@ -911,17 +981,112 @@ int main(int argc, char **argv) {
 			prepend += "#define Point4 vec4\n";
 			prepend += "#define Mat4 mat4\n";
 			prepend += "precision highp float;\n";
+
+			/* frame and material uniforms are grouped into std140 blocks
+			 * so the renderer can upload each of them once
+			 */
+			using member = std::tuple<std::string, std::string>;
+			static const std::vector<member> frameMembers = {
+			    {"Mat4", "u_projection"}, {"Mat4", "u_view"}, {"Mat4", "u_invViewProj"}};
+			static const std::vector<member> materialMembers = {
+			    {"Point3", "u_ambient"}, {"Point3", "u_diffuse"},
+			    {"Point3", "u_specular"}, {"Decimal", "u_specular_exponent"}};
+
+			auto glsltype = [](const std::string &type) -> std::string {
+				if(type == "Decimal") { return "float"; }
+				if(type == "Point2") { return "vec2"; }
+				if(type == "Point3") { return "vec3"; }
+				if(type == "Point4") { return "vec4"; }
+				if(type == "Mat4") { return "mat4"; }
+				return type;
+			};
+			auto inblock = [&glsltype](const std::vector<member> &members, const member &uniform) {
+				for(auto &m : members) {
+					if(std::get<1>(m) == std::get<1>(uniform)) {
+						return glsltype(std::get<0>(m)) == glsltype(std::get<0>(uniform));
+					}
+				}
+				return false;
+			};
+			auto block = [](const std::string &name, const std::vector<member> &members) {
+				std::string s = "layout(std140) uniform " + name + " {\n";
+				for(auto &m : members) {
+					s += '\t' + std::get<0>(m) + ' ' + std::get<1>(m) + ";\n";
+				}
+				return s + "};\n";
+			};
+
+			bool frameBlock = false, materialBlock = false;
 			for(auto &uniform : uniforms) {
-				prepend += "uniform " + std::get<0>(uniform) + ' ' +
-				           std::get<1>(uniform) + ";\n";
+				if(inblock(frameMembers, uniform)) {
+					frameBlock = true;
+				} else if(inblock(materialMembers, uniform)) {
+					materialBlock = true;
+				} else {
+					prepend += "uniform " + std::get<0>(uniform) + ' ' +
+					           std::get<1>(uniform) + ";\n";
+				}
+			}
+			bool vertex = shader.type == support::shader::shadertype::vertex;
+
+			/* single-pass stereo draws every instance twice side by side, the
+			 * frame block holds matrices for both eyes and the eye is picked
+			 * per instance in vertex shaders and per pixel in fragment shaders
+			 */
+			if(vertex) { prepend += "uniform int polar_instances;\n"; }
+			if(frameBlock) {
+				prepend += "layout(std140) uniform polar_frame {\n"
+				           "\tMat4 polar_projection[2];\n"
+				           "\tMat4 polar_view[2];\n"
+				           "\tMat4 polar_invViewProj[2];\n"
+				           "\tPoint4 polar_stereo;\n"
+				           "};\n";
+				if(vertex) {
+					prepend += "#define polar_eye (polar_instances > 1 ? gl_InstanceID % 2 : 0)\n";
+				} else {
+					prepend += "#define polar_eye (polar_stereo.x > 1.0 && gl_FragCoord.x >= polar_stereo.y ? 1 : 0)\n";
+				}
+				for(auto &m : frameMembers) {
+					auto &name = std::get<1>(m);
+					prepend += "#define " + name + " polar_" + name.substr(2) + "[polar_eye]\n";
+				}
+			}
+			if(materialBlock) { prepend += block("polar_material", materialMembers); }
+
+			std::string append;
+			if(vertex) {
+				// squash each eye into its half of the target and clip it at the seam
+				prepend += "#define main polar_main\n";
+				append += "#undef main\n"
+				          "void main() {\n"
+				          "\tpolar_main();\n"
+				          "\tif(polar_instances > 1) {\n"
+				          "\t\tfloat side = float(gl_InstanceID % 2) * 2.0 - 1.0;\n"
+				          "\t\tgl_ClipDistance[0] = gl_Position.w + side * gl_Position.x;\n"
+				          "\t\tgl_Position.x = gl_Position.x * 0.5 + side * 0.5 * gl_Position.w;\n"
+				          "\t}\n"
+				          "}\n";
 			}
-			if(shader.type == support::shader::shadertype::vertex) {
+
+			if(vertex) {
 				int attribLoc = 0;
 				for(auto &attrib : attribs) {
 					prepend += "layout(location=" +
-					           std::to_string(attribLoc++) + ") in " +
+					           std::to_string(attribLoc) + ") in " +
 					           std::get<0>(attrib) + ' ' + std::get<1>(attrib) +
 					           ";\n";
+
+					// matrix attributes take one location per column
+					auto &type = std::get<0>(attrib);
+					if(type == "Mat4" || type == "mat4") {
+						attribLoc += 4;
+					} else if(type == "mat3") {
+						attribLoc += 3;
+					} else if(type == "mat2") {
+						attribLoc += 2;
+					} else {
+						++attribLoc;
+					}
 				}
 				for(auto &varying : varyings) {
 					prepend += std::get<0>(varying) + " out " +
@@ -941,7 +1106,7 @@ int main(int argc, char **argv) {
 					           std::get<1>(out) + ";\n";
 				}
 			}
-			shader.source = prepend + shader.source;
+			shader.source = prepend + shader.source + append;
 		}
 
 		s << asset;
@@ -0,0 +1,208 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <polar/support/mesh/optimize.h>
+#include <unordered_map>
+
+namespace polar::support::mesh {
+	namespace {
+		struct vertexkey {
+			const polar::asset::vertex *v;
+
+			friend inline bool operator==(const vertexkey &lhs, const vertexkey &rhs) {
+				return std::memcmp(lhs.v, rhs.v, sizeof(polar::asset::vertex)) == 0;
+			}
+		};
+
+		struct vertexhash {
+			size_t operator()(const vertexkey &key) const {
+				// FNV-1a over the raw bytes, matching the bitwise equality above
+				auto bytes = reinterpret_cast<const uint8_t *>(key.v);
+				uint64_t h = 14695981039346656037ull;
+				for(size_t i = 0; i < sizeof(polar::asset::vertex); ++i) {
+					h ^= bytes[i];
+					h *= 1099511628211ull;
+				}
+				return size_t(h);
+			}
+		};
+
+		const size_t cache_size         = 32;
+		const float cache_decay_power   = 1.5f;
+		const float last_tri_score      = 0.75f;
+		const float valence_boost_scale = 2.0f;
+		const float valence_boost_power = 0.5f;
+
+		float vertexscore(int cachePos, uint32_t remaining) {
+			if(remaining == 0) { return -1.0f; }
+
+			float score = 0;
+			if(cachePos >= 0) {
+				if(cachePos < 3) {
+					// the three most recent vertices belong to the last triangle
+					score = last_tri_score;
+				} else {
+					const float scaler = 1.0f / (cache_size - 3);
+					score              = std::pow(1.0f - (cachePos - 3) * scaler, cache_decay_power);
+				}
+			}
+
+			// boost vertices with few triangles left so they are finished off
+			score += valence_boost_scale * std::pow(float(remaining), -valence_boost_power);
+			return score;
+		}
+	} // namespace
+
+	void weld(const std::vector<polar::asset::vertex> &soup, std::vector<polar::asset::vertex> &vertices,
+	          std::vector<uint32_t> &indices) {
+		vertices.clear();
+		indices.clear();
+		vertices.reserve(soup.size());
+		indices.reserve(soup.size());
+
+		std::unordered_map<vertexkey, uint32_t, vertexhash> seen;
+		seen.reserve(soup.size());
+
+		for(auto &v : soup) {
+			auto it = seen.emplace(vertexkey{&v}, uint32_t(vertices.size()));
+			if(it.second) { vertices.emplace_back(v); }
+			indices.emplace_back(it.first->second);
+		}
+	}
+
+	void optimize_cache(std::vector<uint32_t> &indices, size_t vertexCount) {
+		size_t triCount = indices.size() / 3;
+		if(triCount == 0) { return; }
+
+		// adjacency from vertices to the triangles using them
+		std::vector<uint32_t> remaining(vertexCount, 0);
+		for(auto i : indices) { ++remaining[i]; }
+
+		std::vector<uint32_t> offsets(vertexCount + 1, 0);
+		for(size_t v = 0; v < vertexCount; ++v) { offsets[v + 1] = offsets[v] + remaining[v]; }
+
+		std::vector<uint32_t> adjacency(indices.size());
+		std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+		for(size_t t = 0; t < triCount; ++t) {
+			for(size_t k = 0; k < 3; ++k) { adjacency[fill[indices[t * 3 + k]]++] = uint32_t(t); }
+		}
+
+		std::vector<float> vscore(vertexCount);
+		for(size_t v = 0; v < vertexCount; ++v) { vscore[v] = vertexscore(-1, remaining[v]); }
+
+		std::vector<float> tscore(triCount);
+		std::vector<bool> emitted(triCount, false);
+		for(size_t t = 0; t < triCount; ++t) {
+			tscore[t] = vscore[indices[t * 3]] + vscore[indices[t * 3 + 1]] + vscore[indices[t * 3 + 2]];
+		}
+
+		std::vector<uint32_t> output;
+		output.reserve(indices.size());
+
+		std::vector<uint32_t> cache, next;
+		cache.reserve(cache_size + 3);
+		next.reserve(cache_size + 3);
+
+		size_t cursor = 0;
+		int64_t best  = -1;
+		while(output.size() < indices.size()) {
+			// no candidate from the cache, fall back to the best untouched triangle
+			if(best < 0) {
+				float bestScore = -1;
+				for(size_t t = cursor; t < triCount; ++t) {
+					if(!emitted[t] && tscore[t] > bestScore) {
+						bestScore = tscore[t];
+						best      = int64_t(t);
+					}
+				}
+				while(cursor < triCount && emitted[cursor]) { ++cursor; }
+			}
+
+			auto t     = size_t(best);
+			emitted[t] = true;
+
+			next.clear();
+			for(size_t k = 0; k < 3; ++k) {
+				auto v = indices[t * 3 + k];
+				output.emplace_back(v);
+				next.emplace_back(v);
+				--remaining[v];
+
+				// drop the emitted triangle from the vertex's adjacency
+				auto first = adjacency.begin() + offsets[v];
+				auto last  = first + remaining[v] + 1;
+				*std::find(first, last, uint32_t(t)) = *(last - 1);
+			}
+			for(auto v : cache) {
+				if(std::find(next.begin(), next.end(), v) == next.end()) { next.emplace_back(v); }
+			}
+
+			// vertices pushed out of the cache lose their position score, and so do their triangles
+			for(size_t c = cache_size; c < next.size(); ++c) {
+				auto v    = next[c];
+				vscore[v] = vertexscore(-1, remaining[v]);
+				for(uint32_t a = offsets[v]; a < offsets[v] + remaining[v]; ++a) {
+					auto tri = adjacency[a];
+					tscore[tri] =
+					    vscore[indices[tri * 3]] + vscore[indices[tri * 3 + 1]] + vscore[indices[tri * 3 + 2]];
+				}
+			}
+			if(next.size() > cache_size) { next.resize(cache_size); }
+			cache.swap(next);
+
+			for(size_t c = 0; c < cache.size(); ++c) {
+				auto v    = cache[c];
+				vscore[v] = vertexscore(int(c), remaining[v]);
+			}
+
+			// rescore triangles touching the cache and pick the next one among them
+			best            = -1;
+			float bestScore = -1;
+			for(auto v : cache) {
+				for(uint32_t a = offsets[v]; a < offsets[v] + remaining[v]; ++a) {
+					auto tri = adjacency[a];
+					tscore[tri] =
+					    vscore[indices[tri * 3]] + vscore[indices[tri * 3 + 1]] + vscore[indices[tri * 3 + 2]];
+					if(tscore[tri] > bestScore) {
+						bestScore = tscore[tri];
+						best      = int64_t(tri);
+					}
+				}
+			}
+		}
+
+		indices.swap(output);
+	}
+
+	void optimize_fetch(std::vector<polar::asset::vertex> &vertices, std::vector<uint32_t> &indices) {
+		std::vector<uint32_t> remap(vertices.size(), UINT32_MAX);
+		std::vector<polar::asset::vertex> ordered;
+		ordered.reserve(vertices.size());
+
+		for(auto &i : indices) {
+			if(remap[i] == UINT32_MAX) {
+				remap[i] = uint32_t(ordered.size());
+				ordered.emplace_back(vertices[i]);
+			}
+			i = remap[i];
+		}
+
+		vertices.swap(ordered);
+	}
+
+	float acmr(const std::vector<uint32_t> &indices, size_t cacheSize) {
+		if(indices.size() < 3) { return 0; }
+
+		std::deque<uint32_t> fifo;
+		size_t misses = 0;
+		for(auto i : indices) {
+			if(std::find(fifo.begin(), fifo.end(), i) == fifo.end()) {
+				++misses;
+				fifo.emplace_back(i);
+				if(fifo.size() > cacheSize) { fifo.pop_front(); }
+			}
+		}
+		return float(misses) / float(indices.size() / 3);
+	}
+} // namespace polar::support::mesh
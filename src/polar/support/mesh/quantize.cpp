@@ -0,0 +1,202 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <glm/glm.hpp>
+#include <polar/support/mesh/quantize.h>
+
+namespace polar::support::mesh {
+	namespace {
+		inline int16_t snorm16(float f) {
+			return int16_t(std::lround(std::max(-1.0f, std::min(1.0f, f)) * 32767.0f));
+		}
+
+		inline uint32_t snorm10(float f) {
+			return uint32_t(std::lround(std::max(-1.0f, std::min(1.0f, f)) * 511.0f)) & 0x3ff;
+		}
+
+		inline float unsnorm10(uint32_t bits) {
+			// sign extend the 10 bit field
+			auto v = int32_t(bits << 22) >> 22;
+			return std::max(-1.0f, float(v) / 511.0f);
+		}
+	} // namespace
+
+	uint16_t tohalf(float f) {
+		uint32_t bits;
+		std::memcpy(&bits, &f, sizeof(bits));
+
+		uint16_t sign = uint16_t((bits >> 16) & 0x8000);
+		int32_t exp   = int32_t((bits >> 23) & 0xff) - 127 + 15;
+		uint32_t mant = bits & 0x7fffff;
+
+		if(exp >= 31) {
+			// overflow and infinity clamp to infinity, NaN keeps a mantissa bit
+			bool nan = ((bits >> 23) & 0xff) == 0xff && mant != 0;
+			return uint16_t(sign | 0x7c00 | (nan ? 0x200 : 0));
+		}
+		if(exp <= 0) {
+			if(exp < -10) { return sign; }
+
+			// denormal, shift in the implicit leading one
+			mant |= 0x800000;
+			auto shift    = uint32_t(14 - exp);
+			uint32_t half = mant >> shift;
+			if((mant >> (shift - 1)) & 1) { ++half; }
+			return uint16_t(sign | half);
+		}
+
+		uint32_t half = uint32_t(exp) << 10 | mant >> 13;
+		// round to nearest, a carry into the exponent is still correct
+		if(mant & 0x1000) { ++half; }
+		return uint16_t(sign | half);
+	}
+
+	float fromhalf(uint16_t h) {
+		uint32_t sign = uint32_t(h & 0x8000) << 16;
+		uint32_t exp  = (h >> 10) & 0x1f;
+		uint32_t mant = h & 0x3ff;
+
+		uint32_t bits;
+		if(exp == 0) {
+			if(mant == 0) {
+				bits = sign;
+			} else {
+				// renormalize the denormal
+				exp = 127 - 15 + 1;
+				while(!(mant & 0x400)) {
+					mant <<= 1;
+					--exp;
+				}
+				bits = sign | exp << 23 | (mant & 0x3ff) << 13;
+			}
+		} else if(exp == 31) {
+			bits = sign | 0x7f800000 | mant << 13;
+		} else {
+			bits = sign | (exp - 15 + 127) << 23 | mant << 13;
+		}
+
+		float f;
+		std::memcpy(&f, &bits, sizeof(f));
+		return f;
+	}
+
+	uint32_t packnormal(const math::point3 &n) {
+		return snorm10(n.x) | snorm10(n.y) << 10 | snorm10(n.z) << 20;
+	}
+
+	math::point3 unpacknormal(uint32_t packed) {
+		return math::point3(unsnorm10(packed & 0x3ff), unsnorm10((packed >> 10) & 0x3ff),
+		                    unsnorm10((packed >> 20) & 0x3ff));
+	}
+
+	void bounds(const std::vector<polar::asset::vertex> &vertices, math::point3 &lo, math::point3 &hi, float &radius) {
+		lo     = math::point3(0);
+		hi     = math::point3(0);
+		radius = 0;
+		if(vertices.empty()) { return; }
+
+		lo = hi = vertices[0].position;
+		for(auto &v : vertices) {
+			lo = glm::min(lo, v.position);
+			hi = glm::max(hi, v.position);
+		}
+
+		// tighter than half the box diagonal for most meshes
+		auto center   = (lo + hi) * 0.5f;
+		float radius2 = 0;
+		for(auto &v : vertices) {
+			auto d  = v.position - center;
+			radius2 = std::max(radius2, d.x * d.x + d.y * d.y + d.z * d.z);
+		}
+		radius = std::sqrt(radius2);
+	}
+
+	void quantize(const std::vector<polar::asset::vertex> &vertices, std::vector<polar::asset::packedvertex> &packed,
+	              math::point3 &center, float &extent) {
+		packed.clear();
+		center = math::point3(0);
+		extent = 1;
+		if(vertices.empty()) { return; }
+
+		math::point3 lo, hi;
+		float radius;
+		bounds(vertices, lo, hi, radius);
+
+		center = (lo + hi) * 0.5f;
+		auto e = (hi - lo) * 0.5f;
+		extent = std::max(e.x, std::max(e.y, e.z));
+		if(!(extent > 0)) { extent = 1; }
+
+		packed.resize(vertices.size());
+		for(size_t i = 0; i < vertices.size(); ++i) {
+			auto &v = vertices[i];
+			auto &p = packed[i];
+
+			auto rel   = (v.position - center) / extent;
+			p.position = {{snorm16(rel.x), snorm16(rel.y), snorm16(rel.z), 0}};
+			p.normal   = packnormal(v.normal);
+			p.texcoord = {{tohalf(v.texcoord.x), tohalf(v.texcoord.y)}};
+		}
+	}
+
+	void dequantize(const std::vector<polar::asset::packedvertex> &packed, const math::point3 &center, float extent,
+	                std::vector<polar::asset::vertex> &vertices) {
+		auto unsnorm16 = [] (int16_t x) { return std::max(-1.0f, float(x) / 32767.0f); };
+
+		vertices.resize(packed.size());
+		for(size_t i = 0; i < packed.size(); ++i) {
+			auto &p = packed[i];
+			auto &v = vertices[i];
+
+			auto rel   = math::point3(unsnorm16(p.position[0]), unsnorm16(p.position[1]), unsnorm16(p.position[2]));
+			v.position = center + rel * extent;
+			v.normal   = unpacknormal(p.normal);
+			v.texcoord = math::point2(fromhalf(p.texcoord[0]), fromhalf(p.texcoord[1]));
+		}
+	}
+
+	void generate_normals(std::vector<polar::asset::vertex> &vertices, const std::vector<uint32_t> &indices) {
+		std::vector<bool> missing(vertices.size());
+		bool any = false;
+		for(size_t i = 0; i < vertices.size(); ++i) {
+			missing[i] = vertices[i].normal == math::point3(0, 0, 0);
+			any        = any || missing[i];
+		}
+		if(!any) { return; }
+
+		for(size_t i = 0; i + 2 < indices.size(); i += 3) {
+			auto &p = vertices[indices[i]];
+			auto &q = vertices[indices[i + 1]];
+			auto &r = vertices[indices[i + 2]];
+
+			auto delta1 = q.position - p.position;
+			auto delta2 = r.position - p.position;
+
+			math::point3 normal;
+			normal.x = delta1.y * delta2.z - delta1.z * delta2.y;
+			normal.y = delta1.z * delta2.x - delta1.x * delta2.z;
+			normal.z = delta1.x * delta2.y - delta1.y * delta2.x;
+
+			// degenerate faces have no direction to contribute
+			auto length = glm::length(normal);
+			if(length <= 0) { continue; }
+			normal /= length;
+
+			for(size_t k = 0; k < 3; ++k) {
+				if(missing[indices[i + k]]) { vertices[indices[i + k]].normal += normal; }
+			}
+		}
+
+		for(size_t i = 0; i < vertices.size(); ++i) {
+			if(!missing[i]) { continue; }
+
+			// vertices only touched by degenerate faces, or whose faces cancel out, get a fixed normal
+			auto length = glm::length(vertices[i].normal);
+			if(length > 0) {
+				vertices[i].normal /= length;
+			} else {
+				vertices[i].normal = math::point3(0, 0, 1);
+			}
+		}
+	}
+} // namespace polar::support::mesh
@@ -0,0 +1,248 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <glm/glm.hpp>
+#include <polar/support/mesh/simplify.h>
+#include <unordered_map>
+
+namespace polar::support::mesh {
+	namespace {
+		struct positionkey {
+			const math::point3 *p;
+
+			friend inline bool operator==(const positionkey &lhs, const positionkey &rhs) {
+				return std::memcmp(lhs.p, rhs.p, sizeof(math::point3)) == 0;
+			}
+		};
+
+		struct positionhash {
+			size_t operator()(const positionkey &key) const {
+				auto bytes = reinterpret_cast<const uint8_t *>(key.p);
+				uint64_t h = 14695981039346656037ull;
+				for(size_t i = 0; i < sizeof(math::point3); ++i) {
+					h ^= bytes[i];
+					h *= 1099511628211ull;
+				}
+				return size_t(h);
+			}
+		};
+
+		/* sum of squared distances to a set of planes, weighted by their area
+		 *
+		 * the symmetric 4x4 matrix is stored as its upper triangle
+		 *
+		 *   0 1 2 3
+		 *     4 5 6
+		 *       7 8
+		 *         9
+		 */
+		struct quadric {
+			std::array<double, 10> m{};
+			double weight = 0;
+
+			void addplane(const glm::dvec3 &n, double d, double w) {
+				const double p[4] = {n.x, n.y, n.z, d};
+				size_t k          = 0;
+				for(size_t i = 0; i < 4; ++i) {
+					for(size_t j = i; j < 4; ++j) { m[k++] += w * p[i] * p[j]; }
+				}
+				weight += w;
+			}
+
+			quadric &operator+=(const quadric &rhs) {
+				for(size_t k = 0; k < m.size(); ++k) { m[k] += rhs.m[k]; }
+				weight += rhs.weight;
+				return *this;
+			}
+
+			// mean squared distance of v to the planes
+			double error(const math::point3 &v) const {
+				if(weight <= 0) { return 0; }
+
+				double x = v.x, y = v.y, z = v.z;
+				double e = m[0] * x * x + 2 * m[1] * x * y + 2 * m[2] * x * z + 2 * m[3] * x + m[4] * y * y +
+				           2 * m[5] * y * z + 2 * m[6] * y + m[7] * z * z + 2 * m[8] * z + m[9];
+				return std::max(0.0, e) / weight;
+			}
+		};
+
+		struct collapse {
+			uint32_t from;
+			uint32_t to;
+			double cost;
+		};
+
+		inline glm::dvec3 facenormal(const math::point3 &a, const math::point3 &b, const math::point3 &c) {
+			return glm::cross(glm::dvec3(b - a), glm::dvec3(c - a));
+		}
+	} // namespace
+
+	std::vector<uint32_t> simplify(const std::vector<polar::asset::vertex> &vertices,
+	                               const std::vector<uint32_t> &indices, size_t targetIndexCount, float maxError,
+	                               float *resultError) {
+		std::vector<uint32_t> result(indices);
+		double reached = 0;
+
+		auto count = vertices.size();
+
+		// vertices split only by their normal or texcoord share a position and move as one
+		std::vector<uint32_t> position(count);
+		std::vector<uint32_t> wedges(count, 0);
+		{
+			std::unordered_map<positionkey, uint32_t, positionhash> seen;
+			seen.reserve(count);
+			for(size_t v = 0; v < count; ++v) {
+				position[v] = seen.emplace(positionkey{&vertices[v].position}, uint32_t(v)).first->second;
+				++wedges[position[v]];
+			}
+		}
+
+		/* seams would tear if one side moved, and open borders or non-manifold
+		 * edges would shrink the outline, so their vertices are never collapsed
+		 */
+		std::vector<uint8_t> locked(count, 0);
+		{
+			std::unordered_map<uint64_t, uint32_t> edges;
+			edges.reserve(result.size());
+			for(size_t i = 0; i < result.size(); i += 3) {
+				for(size_t k = 0; k < 3; ++k) {
+					uint64_t a = position[result[i + k]], b = position[result[i + (k + 1) % 3]];
+					if(a > b) { std::swap(a, b); }
+					++edges[a << 32 | b];
+				}
+			}
+			for(auto &pair : edges) {
+				if(pair.second != 2) {
+					locked[pair.first >> 32]        = 1;
+					locked[pair.first & 0xffffffff] = 1;
+				}
+			}
+			for(size_t v = 0; v < count; ++v) {
+				if(wedges[position[v]] > 1) { locked[position[v]] = 1; }
+			}
+		}
+
+		std::vector<quadric> quadrics(count);
+		for(size_t i = 0; i < result.size(); i += 3) {
+			auto &a = vertices[result[i]].position;
+			auto n  = facenormal(a, vertices[result[i + 1]].position, vertices[result[i + 2]].position);
+			auto l  = glm::length(n);
+			if(l <= 0) { continue; }
+
+			n /= l;
+			auto d = -glm::dot(n, glm::dvec3(a));
+			for(size_t k = 0; k < 3; ++k) { quadrics[position[result[i + k]]].addplane(n, d, l * 0.5); }
+		}
+
+		double limit = double(maxError) * double(maxError);
+
+		std::vector<uint32_t> remap(count);
+		std::vector<uint8_t> touched(count);
+		std::vector<uint32_t> adjacencyOffsets(count + 1);
+		std::vector<uint32_t> adjacency;
+		std::vector<collapse> candidates;
+
+		/* every pass collapses the cheapest edges whose neighbourhoods do not
+		 * overlap, so the costs a pass relies on stay valid until it ends
+		 */
+		while(result.size() > targetIndexCount) {
+			// triangles around each vertex
+			std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+			for(auto i : result) { ++adjacencyOffsets[i + 1]; }
+			for(size_t v = 0; v < count; ++v) { adjacencyOffsets[v + 1] += adjacencyOffsets[v]; }
+			adjacency.resize(result.size());
+			{
+				auto fill = adjacencyOffsets;
+				for(size_t i = 0; i < result.size(); ++i) { adjacency[fill[result[i]]++] = uint32_t(i / 3); }
+			}
+
+			// the cheapest way to collapse each free vertex onto one of its neighbours
+			candidates.clear();
+			for(size_t v = 0; v < count; ++v) {
+				if(locked[v] || position[v] != v) { continue; }
+
+				collapse best{uint32_t(v), uint32_t(v), limit};
+				for(auto a = adjacencyOffsets[v]; a < adjacencyOffsets[v + 1]; ++a) {
+					auto t = adjacency[a] * 3;
+					for(size_t k = 0; k < 3; ++k) {
+						auto to = result[t + k];
+						if(position[to] == v) { continue; }
+
+						auto q = quadrics[v];
+						q += quadrics[position[to]];
+						auto cost = q.error(vertices[to].position);
+						if(cost <= best.cost) { best = collapse{uint32_t(v), to, cost}; }
+					}
+				}
+				if(best.to != v) { candidates.emplace_back(best); }
+			}
+			if(candidates.empty()) { break; }
+
+			std::sort(candidates.begin(), candidates.end(),
+			          [] (const collapse &lhs, const collapse &rhs) { return lhs.cost < rhs.cost; });
+
+			// an interior collapse removes two triangles
+			size_t wanted  = std::max(size_t(1), (result.size() - targetIndexCount) / 6);
+			size_t applied = 0;
+
+			for(size_t v = 0; v < count; ++v) { remap[v] = uint32_t(v); }
+			std::fill(touched.begin(), touched.end(), 0);
+
+			for(auto &c : candidates) {
+				if(applied >= wanted) { break; }
+				if(touched[c.from] || touched[position[c.to]]) { continue; }
+
+				// reject collapses that would fold a remaining triangle over
+				auto &target = vertices[c.to].position;
+				bool flips   = false;
+				for(auto a = adjacencyOffsets[c.from]; a < adjacencyOffsets[c.from + 1] && !flips; ++a) {
+					auto t = adjacency[a] * 3;
+					std::array<uint32_t, 3> tri = {result[t], result[t + 1], result[t + 2]};
+
+					bool collapsing = false;
+					for(auto i : tri) { collapsing = collapsing || position[i] == position[c.to]; }
+					if(collapsing) { continue; }
+
+					std::array<math::point3, 3> moved;
+					for(size_t k = 0; k < 3; ++k) {
+						moved[k] = tri[k] == c.from ? target : vertices[tri[k]].position;
+					}
+
+					auto before = facenormal(vertices[tri[0]].position, vertices[tri[1]].position,
+					                         vertices[tri[2]].position);
+					auto after  = facenormal(moved[0], moved[1], moved[2]);
+					flips       = glm::dot(before, after) <= 0;
+				}
+				if(flips) { continue; }
+
+				for(auto a = adjacencyOffsets[c.from]; a < adjacencyOffsets[c.from + 1]; ++a) {
+					auto t = adjacency[a] * 3;
+					for(size_t k = 0; k < 3; ++k) { touched[position[result[t + k]]] = 1; }
+				}
+
+				remap[c.from] = c.to;
+				quadrics[position[c.to]] += quadrics[c.from];
+				reached = std::max(reached, c.cost);
+				++applied;
+			}
+			if(applied == 0) { break; }
+
+			// drop the triangles whose corners now share a position
+			size_t written = 0;
+			for(size_t i = 0; i < result.size(); i += 3) {
+				auto a = remap[result[i]], b = remap[result[i + 1]], c = remap[result[i + 2]];
+				if(position[a] == position[b] || position[b] == position[c] || position[c] == position[a]) {
+					continue;
+				}
+				result[written++] = a;
+				result[written++] = b;
+				result[written++] = c;
+			}
+			result.resize(written);
+		}
+
+		if(resultError != nullptr) { *resultError = float(std::sqrt(reached)); }
+		return result;
+	}
+} // namespace polar::support::mesh
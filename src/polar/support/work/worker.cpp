@@ -1,3 +1,4 @@
+#include <optional>
 #include <polar/core/log.h>
 #include <polar/support/work/worker.h>
 
@@ -5,24 +6,20 @@ namespace polar::support::work {
 		void worker::start() {
 			auto fn = [this]() {
 				while(true) {
-					if(jobs.with<bool>(
-					       [](job_queue_t &jobs) { return jobs.empty(); })) {
-						std::this_thread::sleep_for(
-						    std::chrono::milliseconds(5));
-					} else {
-						auto job = jobs.with<job_t>([](job_queue_t &jobs) {
-							auto job = jobs.top();
-							jobs.pop();
-							return job;
-						});
-						switch(job.type) {
-						case job_type::work:
-							job.fn();
-							break;
-						case job_type::stop:
-							log()->verbose("work", "worker received stop command");
-							return;
-						}
+					// sleep until a job is queued instead of polling
+					std::optional<job_t> job;
+					jobs.wait([](job_queue_t &jobs) { return !jobs.empty(); },
+					          [&job](job_queue_t &jobs) {
+						          job = jobs.top();
+						          jobs.pop();
+					          });
+					switch(job->type) {
+					case job_type::work:
+						job->fn();
+						break;
+					case job_type::stop:
+						log()->verbose("work", "worker received stop command");
+						return;
 					}
 				}
 			};
@@ -0,0 +1,104 @@
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/quaternion.hpp>
+#include <glm/gtx/transform.hpp>
+#include <polar/core/polar.h>
+#include <polar/system/hierarchy.h>
+
+namespace polar::system {
+	void hierarchy::push(core::weak_ref object, size_t parent) {
+		node n;
+		n.object = object;
+		n.parent = parent;
+
+		auto ref_range = engine->objects.get<core::index::ref>().equal_range(object);
+		for(auto ref_it = ref_range.first; ref_it != ref_range.second; ++ref_it) {
+			auto type = ref_it->ti;
+			if(type == typeid(component::position)) {
+				n.pos = static_cast<component::position *>(ref_it->ptr.get());
+			} else if(type == typeid(component::orientation)) {
+				n.orient = static_cast<component::orientation *>(ref_it->ptr.get());
+			} else if(type == typeid(component::scale)) {
+				n.sc = static_cast<component::scale *>(ref_it->ptr.get());
+			}
+		}
+
+		indices.emplace(object.id(), nodes.size());
+		nodes.emplace_back(n);
+	}
+
+	void hierarchy::rebuild() {
+		nodes.clear();
+		indices.clear();
+
+		auto &ref_index = engine->objects.get<core::index::ref>();
+
+		std::unordered_multimap<core::weak_ref, core::weak_ref> children;
+		std::unordered_set<core::weak_ref> parents;
+		std::vector<core::weak_ref> roots;
+
+		auto ti_range = engine->objects.get<core::index::ti>().equal_range(typeid(component::parent));
+		for(auto ti_it = ti_range.first; ti_it != ti_range.second; ++ti_it) {
+			auto p = static_cast<component::parent *>(ti_it->ptr.get());
+
+			// children of destroyed objects become roots
+			if(ref_index.find(p->target) == ref_index.end()) {
+				roots.emplace_back(ti_it->r);
+			} else {
+				children.emplace(p->target, ti_it->r);
+				parents.emplace(p->target);
+			}
+		}
+
+		for(auto &r : parents) {
+			if(engine->get<component::parent>(r) == nullptr) { roots.emplace_back(r); }
+		}
+
+		for(auto &r : roots) { push(r, npos); }
+		for(size_t i = 0; i < nodes.size(); ++i) {
+			auto object = nodes[i].object;
+			auto range  = children.equal_range(object);
+			for(auto it = range.first; it != range.second; ++it) { push(it->second, i); }
+		}
+
+		if(nodes.size() < children.size() + roots.size()) {
+			log()->warning("hierarchy", "ignoring ", children.size() + roots.size() - nodes.size(),
+			               " objects in parent cycles");
+		}
+
+		structure_dirty = false;
+	}
+
+	void hierarchy::propagate(math::decimal delta) {
+		if(structure_dirty) { rebuild(); }
+
+		size_t recomputed = 0;
+		for(auto &n : nodes) {
+			auto translation = n.pos ? n.pos->pos.temporal(delta) : math::point3(0);
+			auto rotation    = n.orient ? n.orient->orient.temporal(delta) : math::quat(1, 0, 0, 0);
+			auto scaling     = n.sc ? n.sc->sc.temporal(delta) : math::point3(1);
+
+			if(n.dirty || translation != n.translation || rotation != n.rotation || scaling != n.scaling) {
+				n.translation = translation;
+				n.rotation    = rotation;
+				n.scaling     = scaling;
+
+				n.local = glm::translate(math::mat4x4(1), translation);
+				n.local *= glm::toMat4(glm::inverse(rotation));
+				n.local = glm::scale(n.local, scaling);
+
+				n.changed = true;
+			} else {
+				n.changed = n.parent != npos && nodes[n.parent].changed;
+			}
+
+			if(n.changed) {
+				n.world = n.parent != npos ? nodes[n.parent].world * n.local : n.local;
+				++recomputed;
+			}
+
+			n.dirty = false;
+		}
+
+		last_recomputed = recomputed;
+	}
+} // namespace polar::system
@@ -8,7 +8,7 @@ namespace polar::system {
 		for(auto it = index.begin(); it != index.end(); ++it) {
 			auto property = it->ptr->get<property::integrable>();
 			if(property) {
-				for(auto integrable : *property->get()) { integrable->integrate(seconds); }
+				for(auto integrable : *property->get()) { integrable->integrate(seconds, default_scheme); }
 			}
 		}
 	}
@@ -5,6 +5,7 @@
 #include <polar/component/scale.h>
 #include <polar/support/phys/detector/ball.h>
 #include <polar/support/phys/detector/box.h>
+#include <polar/system/debugdraw.h>
 #include <polar/system/phys.h>
 #include <polar/tag/clock/simulation.h>
 
@@ -54,9 +55,24 @@ namespace polar::system {
 		});
 	}
 
+	void phys::debugcontact(debugdraw &debug, core::weak_ref a, core::weak_ref b, math::decimal duration) {
+		// resolvers only report an overlap, so the contact is marked between the two origins
+		math::point3 originA{0};
+		math::point3 originB{0};
+		if(auto p = engine->get<component::position>(a)) { originA += p->pos.get(); }
+		if(auto p = engine->get<component::position>(b)) { originB += p->pos.get(); }
+
+		const math::point4 red(1, 0, 0, 1);
+		debug.line(originA, originB, red, duration);
+		debug.point((originA + originB) * math::decimal(0.5), red, duration);
+	}
+
 	void phys::tick(DeltaTicks dt) {
 		auto seconds = dt.Seconds();
 
+		auto debug = engine->get<debugdraw>().lock();
+		if(debug && !debug->active()) { debug.reset(); }
+
 		auto range = engine->objects.get<core::index::ti>().equal_range(typeid(component::phys));
 		for(auto it1 = range.first; it1 != range.second; ++it1) {
 			auto obj1  = it1->r;
@@ -75,6 +91,7 @@ namespace polar::system {
 						auto b = search->second->operator()(engine, {obj1, phys1->detector}, {obj2, phys2->detector});
 						if(b) {
 							// log()->info("phys", "collision!");
+							if(debug) { debugcontact(*debug, obj1, obj2, math::decimal(seconds)); }
 							for(auto &r : phys1->responders) {
 								r->respond(engine, obj1, uint16_t(seconds) * ENGINE_TICKS_PER_SECOND);
 							}
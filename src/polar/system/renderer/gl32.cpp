@@ -1,7 +1,10 @@
 #define GLM_ENABLE_EXPERIMENTAL
+#include <chrono>
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtx/matrix_decompose.hpp>
 #include <glm/gtx/rotate_vector.hpp>
+#include <cstring>
+#include <limits>
 #include <polar/asset/image.h>
 #include <polar/asset/material.h>
 #include <polar/asset/shaderprogram.h>
@@ -14,17 +17,22 @@
 #include <polar/component/text.h>
 #include <polar/core/polar.h>
 #include <polar/math/constants.h>
+#include <polar/math/frustum.h>
 #include <polar/math/mat.h>
 #include <polar/math/point.h>
 #include <polar/support/action/controller.h>
 #include <polar/support/action/keyboard.h>
 #include <polar/support/action/mouse.h>
+#include <polar/support/gl32/shaders.h>
+#include <polar/support/mesh/quantize.h>
 #include <polar/support/phys/detector/ball.h>
 #include <polar/support/phys/detector/box.h>
 #include <polar/system/asset.h>
+#include <polar/system/hierarchy.h>
 #include <polar/system/integrator.h>
 #include <polar/system/renderer/gl32.h>
 #include <polar/system/vr.h>
+#include <polar/system/work.h>
 
 #if defined(_WIN32)
 #define WIN32_LEAN_AND_MEAN
@@ -119,10 +127,10 @@ namespace polar::system::renderer {
 		 */
 		glGetError();
 
-		GL(glEnable(GL_DEPTH_TEST));
-		GL(glEnable(GL_BLEND));
-		GL(glEnable(GL_CULL_FACE));
-		GL(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+		state.enable(GL_DEPTH_TEST, true);
+		state.enable(GL_BLEND, true);
+		state.enable(GL_CULL_FACE, true);
+		state.blendfunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 		GL(glCullFace(GL_BACK));
 
 		if(glewIsExtensionSupported("KHR_debug")) {
@@ -143,7 +151,7 @@ namespace polar::system::renderer {
 		setclearcolor(math::point4(0.0f));
 
 		GL(glGenVertexArrays(1, &viewportVAO));
-		GL(glBindVertexArray(viewportVAO));
+		state.bindvao(viewportVAO);
 
 		GLuint viewport_vbo;
 		GL(glGenBuffers(1, &viewport_vbo));
@@ -170,7 +178,7 @@ namespace polar::system::renderer {
 		// debug box
 
 		GL(glGenVertexArrays(1, &debug_box_vao));
-		GL(glBindVertexArray(debug_box_vao));
+		state.bindvao(debug_box_vao);
 
 		GLuint debug_box_vbo;
 		GL(glGenBuffers(1, &debug_box_vbo));
@@ -234,7 +242,7 @@ namespace polar::system::renderer {
 		// debug ball
 
 		GL(glGenVertexArrays(1, &debug_ball_vao));
-		GL(glBindVertexArray(debug_ball_vao));
+		state.bindvao(debug_ball_vao);
 
 		GLuint debug_ball_vbo;
 		GL(glGenBuffers(1, &debug_ball_vbo));
@@ -269,14 +277,94 @@ namespace polar::system::renderer {
 		GL(glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, NULL));
 		GL(glEnableVertexAttribArray(0));
 
+		// debug lines and points, their vertices are streamed every frame
+
+		GL(glGenVertexArrays(1, &debugLineVAO));
+		state.bindvao(debugLineVAO);
+		GL(glEnableVertexAttribArray(0));
+		GL(glEnableVertexAttribArray(1));
+
+		// instance buffer
+
+		packedNormals = GLEW_VERSION_3_3 || GLEW_ARB_vertex_type_2_10_10_10_rev;
+		if(!packedNormals) { log()->verbose("gl", "packed normals unsupported, expanding compact models on upload"); }
+
+		instancing = GLEW_ARB_instanced_arrays;
+		if(!instancing) { log()->verbose("gl", "ARB_instanced_arrays unsupported, drawing models individually"); }
+
+		// streamed data
+
+		stream.init(1 << 20);
+
+		// ui batches
+
+		GL(glGenVertexArrays(1, &batchVAO));
+		bindbatch();
+
+		{
+			static const uint32_t white = 0xffffffff;
+			GL(glGenTextures(1, &whiteTex));
+			state.bindtexture(whiteTex);
+			GL(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, &white));
+			GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+			GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+		}
+
+		GL(glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxAtlasSize));
+		maxAtlasSize = std::min(maxAtlasSize, GLint(4096));
+		repackatlas(spritePacker.getwidth());
+
+		// uniform blocks
+
+		GL(glGenBuffers(1, &frameUBO));
+
+		programs.init(fs::local::app_dir() / "cache" / "programs");
+		gpu.init();
+
 		log()->trace("gl", "MakePipeline from Init");
 		makepipeline(pipelineNames);
 		log()->trace("gl", "MakePipeline done");
 
 		auto assetM     = engine->get<asset>().lock();
-		spriteProgram   = makeprogram(assetM->get<polar::asset::shaderprogram>("sprite"));
 		identityProgram = makeprogram(assetM->get<polar::asset::shaderprogram>("identity"));
-		debugProgram    = makeprogram(assetM->get<polar::asset::shaderprogram>("debug"));
+
+		{
+			using shadertype = support::shader::shadertype;
+			auto as          = std::make_shared<polar::asset::shaderprogram>();
+			as->shaders.emplace_back(shadertype::vertex, support::gl32::shaders::debug_vertex);
+			as->shaders.emplace_back(shadertype::fragment, support::gl32::shaders::debug_fragment);
+			debugProgram = makeprogram(as);
+		}
+
+		{
+			using shadertype = support::shader::shadertype;
+			auto as          = std::make_shared<polar::asset::shaderprogram>();
+			as->shaders.emplace_back(shadertype::vertex, support::gl32::shaders::batch_vertex);
+			as->shaders.emplace_back(shadertype::fragment, support::gl32::shaders::batch_fragment);
+			batchProgram = makeprogram(as);
+		}
+
+		{
+			using shadertype = support::shader::shadertype;
+			auto as          = std::make_shared<polar::asset::shaderprogram>();
+			as->shaders.emplace_back(shadertype::vertex, support::gl32::shaders::hiz_vertex);
+			as->shaders.emplace_back(shadertype::fragment, support::gl32::shaders::hiz_fragment);
+			hizProgram   = makeprogram(as);
+			hizLocations = resolveuniforms(hizProgram, {"u_footprint", "u_extent"});
+		}
+
+		{
+			using shadertype = support::shader::shadertype;
+			auto as          = std::make_shared<polar::asset::shaderprogram>();
+			as->shaders.emplace_back(shadertype::vertex, support::gl32::shaders::hiz_vertex);
+			as->shaders.emplace_back(shadertype::fragment, support::gl32::shaders::upscale_fragment);
+			upscaleProgram   = makeprogram(as);
+			upscaleLocations = resolveuniforms(upscaleProgram, {"u_output"});
+		}
+
+		batchLocations    = resolveuniforms(batchProgram);
+		identityLocations = resolveuniforms(identityProgram);
+		debugLocations    = resolveuniforms(debugProgram);
 
 		/* 8x8 Bayer ordered dithering pattern
 		 * each input pixel is scaled to the range of 0->63 before lookup
@@ -287,7 +375,7 @@ namespace polar::system::renderer {
 		                                     15, 47, 7,  39, 13, 45, 5,  37, 63, 31, 55, 23, 61, 29, 53, 21};
 
 		GL(glGenTextures(1, &ditherTex));
-		GL(glBindTexture(GL_TEXTURE_2D, ditherTex));
+		state.bindtexture(ditherTex);
 		GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT));
 		GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT));
 		GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
@@ -297,27 +385,411 @@ namespace polar::system::renderer {
 		inited = true;
 	}
 
-	void gl32::render(math::mat4x4 proj, math::mat4x4 view, float delta) {
-		auto assetM = engine->get<asset>().lock();
+	void gl32::prepare(float delta, const math::mat4x4 &view, const math::mat4x4 &proj) {
+		drawentries.clear();
+
+		auto hier = engine->get<hierarchy>().lock();
+		if(hier) { hier->propagate(delta); }
+
+		auto &ref_index = engine->objects.get<core::index::ref>();
+		auto ti_range   = engine->objects.get<core::index::ti>().equal_range(typeid(component::model));
+		for(auto ti_it = ti_range.first; ti_it != ti_range.second; ++ti_it) {
+			auto model    = static_cast<component::model *>(ti_it->ptr.get());
+			auto property = model->get<model_p>();
+			if(!property) { continue; }
+
+			drawentry entry;
+			entry.object   = ti_it->r;
+			entry.model    = model;
+			entry.property = property.get();
+			if(hier) { entry.world = hier->world(entry.object); }
+
+			auto ref_range = ref_index.equal_range(ti_it->r);
+			for(auto ref_it = ref_range.first; ref_it != ref_range.second; ++ref_it) {
+				auto type = ref_it->ti;
+				if(type == typeid(component::position)) {
+					entry.pos = static_cast<component::position *>(ref_it->ptr.get());
+				} else if(type == typeid(component::orientation)) {
+					entry.orient = static_cast<component::orientation *>(ref_it->ptr.get());
+				} else if(type == typeid(component::scale)) {
+					entry.sc = static_cast<component::scale *>(ref_it->ptr.get());
+				} else if(type == typeid(component::phys)) {
+					entry.phys = static_cast<component::phys *>(ref_it->ptr.get());
+				} else if(type == typeid(component::color)) {
+					entry.col = static_cast<component::color *>(ref_it->ptr.get());
+				}
+			}
+
+			drawentries.emplace_back(entry);
+		}
+
+		transforms.resize(drawentries.size());
+		colors.resize(drawentries.size());
+		queue.resize(drawentries.size());
+		cullX.resize(drawentries.size());
+		cullY.resize(drawentries.size());
+		cullZ.resize(drawentries.size());
+		cullR.resize(drawentries.size());
+		visible.resize(drawentries.size());
+		if(debug_draw) { debugtransforms.resize(drawentries.size()); }
+
+		bool instanced = instancing && !nodes.empty() && nodes[0].instanced();
+
+		// pixels covered by one unit at unit distance, with the vertical field of view of the left eye in stereo
+		float lodPixels = proj[1][1] * 0.5f * float(scaledheight());
+
+		// interpolate every transform exactly once per frame, all passes and eyes reuse the result
+		auto fn = [this, delta, &view, instanced, lodPixels](size_t begin, size_t end) {
+			for(size_t e = begin; e < end; ++e) {
+				auto &entry = drawentries[e];
+
+				colors[e] = entry.col ? entry.col->col.temporal(delta) : math::point4(1);
+
+				// attached objects reuse the world matrix cached by the hierarchy
+				if(entry.world) {
+					transforms[e] = *entry.world;
+					if(debug_draw && entry.phys && entry.phys->detector) {
+						debugtransforms[e] = glm::scale(*entry.world, entry.phys->detector->size);
+					}
+				} else {
+					math::point3 pos = entry.pos ? entry.pos->pos.temporal(delta) : math::point3(0);
+					math::point3 sc  = entry.sc ? entry.sc->sc.temporal(delta) : math::point3(1);
+
+					math::mat4x4 modelMatrix = glm::translate(math::mat4x4(1), pos);
+					if(entry.orient) {
+						modelMatrix *= glm::toMat4(glm::inverse(entry.orient->orient.temporal(delta)));
+					}
+					transforms[e] = glm::scale(modelMatrix, sc);
+
+					if(debug_draw && entry.phys && entry.phys->detector) {
+						debugtransforms[e] = glm::scale(glm::scale(glm::translate(math::mat4x4(1), pos), sc),
+						                                entry.phys->detector->size);
+					}
+				}
+
+				auto prop = entry.property;
+				if(prop->compact) { transforms[e] *= prop->dequantize; }
+
+				auto &m    = transforms[e];
+				auto sx    = m[0].x * m[0].x + m[0].y * m[0].y + m[0].z * m[0].z;
+				auto sy    = m[1].x * m[1].x + m[1].y * m[1].y + m[1].z * m[1].z;
+				auto sz    = m[2].x * m[2].x + m[2].y * m[2].y + m[2].z * m[2].z;
+				auto scale = std::sqrt(std::max(sx, std::max(sy, sz)));
+				auto &c    = prop->cullCenter;
+				auto wc    = m * math::point4(c.x, c.y, c.z, 1);
+				if(prop->cullRadius >= 0) {
+					cullX[e] = wc.x;
+					cullY[e] = wc.y;
+					cullZ[e] = wc.z;
+					cullR[e] = prop->cullRadius * scale;
+				} else {
+					cullX[e] = cullY[e] = cullZ[e] = 0;
+					cullR[e] = std::numeric_limits<float>::infinity();
+				}
+
+				// projected error of each level shrinks with distance, up close everything is full detail
+				auto &lods = prop->lods;
+				auto lod   = std::min(entry.model->lod, lods.size() - 1);
+				auto vc    = view * wc;
+				auto dist  = std::sqrt(vc.x * vc.x + vc.y * vc.y + vc.z * vc.z) - cullR[e];
+				if(lods.size() < 2 || !(dist > zNear)) {
+					lod = 0;
+				} else {
+					auto pixels = scale * lodPixels / dist;
+					while(lod > 0 && lods[lod].error * pixels > lodPixelError) { --lod; }
+					while(lod + 1 < lods.size() && lods[lod + 1].error * pixels <= lodPixelError * lodHysteresis) {
+						++lod;
+					}
+				}
+				entry.model->lod = lod;
+				entry.lod        = lod;
+
+				// instanced draws take their textures from the first instance so only the mesh and its detail matter
+				uint64_t key;
+				if(instanced) {
+					key = drawqueue::makekey(0, 0, prop->material_id, prop->mesh_id, entry.lod, 0);
+				} else {
+					auto depth = drawqueue::quantize(-(view * transforms[e][3]).z, zNear, zFar);
+					key        = drawqueue::makekey(0, 0, prop->material_id, prop->mesh_id, prop->diffuse_map, depth);
+				}
+				queue[e] = support::gl32::drawpacket{key, uint32_t(e)};
+			}
+		};
+
+		/* one frustum for every eye, then whatever hid behind the depth of an
+		 * earlier frame is marked occluded, only visible entries reach the queue
+		 *
+		 *   0   outside the frustum
+		 *   1   visible
+		 *   2   occluded
+		 */
+		math::frustum frustum(proj * view);
+		bool occlude = occlusion && hiz.ready();
+		auto cull    = [this, &frustum, occlude](size_t begin, size_t end) {
+			frustum.cull(&cullX[begin], &cullY[begin], &cullZ[begin], &cullR[begin], &visible[begin], end - begin);
+			if(!occlude) { return; }
+
+			for(size_t e = begin; e < end; ++e) {
+				if(visible[e] && hiz.occluded(math::point3(cullX[e], cullY[e], cullZ[e]), cullR[e])) { visible[e] = 2; }
+			}
+		};
+
+		auto w = engine->get<work>().lock();
+		if(w) {
+			w->parallel_for(drawentries.size(), fn, 256);
+			w->parallel_for(drawentries.size(), cull, 1024);
+		} else {
+			fn(0, drawentries.size());
+			cull(0, drawentries.size());
+		}
+
+		queue.remove_if([this] (const support::gl32::drawpacket &p) { return visible[p.index] != 1; });
+		occludedCount = size_t(std::count(visible.begin(), visible.end(), uint8_t(2)));
+		culledCount   = drawentries.size() - queue.size() - occludedCount;
+
+		queue.sort();
+
+		if(instanced) { prepareinstances(); }
+		preparedebug();
+	}
+
+	void gl32::prepareinstances() {
+		auto count = queue.size();
+
+		drawgroups.clear();
+		if(count == 0) { return; }
+
+		// instances go straight into mapped memory the GPU reads from
+		auto alloc     = stream.map(GLsizeiptr(count * sizeof(instancedata)), sizeof(instancedata));
+		auto instances = static_cast<instancedata *>(alloc.ptr);
+
+		// the queue keeps every mesh contiguous, so each run becomes one instanced draw
+		for(size_t k = 0; k < count; ++k) {
+			auto e       = queue[k].index;
+			instances[k] = instancedata{transforms[e], colors[e]};
+
+			auto &prev = drawentries[queue[k == 0 ? 0 : k - 1].index];
+			if(k == 0 || drawentries[e].model->asset != prev.model->asset || drawentries[e].lod != prev.lod) {
+				drawgroups.emplace_back(drawgroup{k, 0});
+			}
+			++drawgroups.back().count;
+		}
+
+		stream.unmap();
+		instanceBuffer = stream.name();
+		instanceOffset = alloc.offset;
+	}
+
+	void gl32::preparedebug() {
+		if(auto dd = engine->get<debugdraw>().lock()) {
+			dd->take(debugBatch);
+		} else {
+			debugBatch.clear();
+		}
+
+		if(debug_draw) {
+			const math::point4 collider(0, 1, 0, 1);
+			for(size_t e = 0; e < drawentries.size(); ++e) {
+				auto phys = drawentries[e].phys;
+				if(phys == nullptr || !phys->detector) { continue; }
+
+				auto &det = *phys->detector;
+				auto ti   = std::type_index(typeid(det));
+				if(ti == typeid(support::phys::detector::box)) {
+					debugBatch.boxes.emplace_back(debugdraw::shape{debugtransforms[e], collider});
+				} else if(ti == typeid(support::phys::detector::ball)) {
+					debugBatch.balls.emplace_back(debugdraw::shape{debugtransforms[e], collider});
+				}
+			}
+		}
+
+		if(debugBatch.empty()) { return; }
+
+		/* boxes then balls as instances, followed by the line and point vertices,
+		 * in a single allocation so that everything lands in the same buffer
+		 */
+		auto &lines  = debugBatch.lines;
+		auto &points = debugBatch.points;
+		auto shapes  = debugBatch.boxes.size() + debugBatch.balls.size();
+
+		const size_t stride = sizeof(debugdraw::vertex);
+		auto shapeBytes     = shapes * sizeof(instancedata);
+		auto alloc          = stream.map(GLsizeiptr(shapeBytes + (lines.size() + points.size()) * stride),
+		                                 sizeof(instancedata));
+
+		auto out = static_cast<instancedata *>(alloc.ptr);
+		for(auto &shape : debugBatch.boxes) { *out++ = instancedata{shape.transform, shape.color}; }
+		for(auto &shape : debugBatch.balls) { *out++ = instancedata{shape.transform, shape.color}; }
+
+		auto vertices = static_cast<char *>(alloc.ptr) + shapeBytes;
+		std::memcpy(vertices, lines.data(), lines.size() * stride);
+		std::memcpy(vertices + lines.size() * stride, points.data(), points.size() * stride);
+
+		stream.unmap();
+		debugBuffer       = stream.name();
+		debugShapeOffset  = alloc.offset;
+		debugVertexOffset = alloc.offset + GLintptr(shapeBytes);
+	}
+
+	void gl32::bindinstances(const pipelinenode &node, size_t first) {
+		// every instance is drawn once per view, so each record advances after that many
+		const GLuint divisor = GLuint(views);
+		const GLsizei stride = sizeof(instancedata);
+		const size_t offset  = size_t(instanceOffset) + first * sizeof(instancedata);
+
+		GL(glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer));
+
+		// a mat4 attribute occupies four consecutive vec4 locations
+		for(GLuint c = 0; c < 4; ++c) {
+			GLuint loc = GLuint(node.instanceModelLoc) + c;
+			GL(glVertexAttribPointer(loc, 4, GL_FLOAT, GL_FALSE, stride, (GLvoid *)(offset + sizeof(math::point4) * c)));
+			GL(glEnableVertexAttribArray(loc));
+			GL(glVertexAttribDivisorARB(loc, divisor));
+		}
+
+		if(node.instanceColorLoc >= 0) {
+			GLuint loc = GLuint(node.instanceColorLoc);
+			GL(glVertexAttribPointer(loc, 4, GL_FLOAT, GL_FALSE, stride, (GLvoid *)(offset + sizeof(math::mat4x4))));
+			GL(glEnableVertexAttribArray(loc));
+			GL(glVertexAttribDivisorARB(loc, divisor));
+		}
+	}
+
+	void gl32::drawdebug(GLsizei eyes) {
+		if(debugBatch.empty()) { return; }
+
+		state.useprogram(debugProgram);
+		uploaduniform(debugLocations[uniform::instances], glm::int32(eyes));
+
+		// lines and points have no transform, and without instanced arrays neither do shapes
+		auto constant = [] (const math::mat4x4 &transform, const math::point4 &color) {
+			for(GLuint c = 0; c < 4; ++c) {
+				GL(glVertexAttrib4f(2 + c, transform[c].x, transform[c].y, transform[c].z, transform[c].w));
+			}
+			GL(glVertexAttrib4f(1, color.r, color.g, color.b, color.a));
+		};
+
+		// one draw per shape type
+		const GLsizei stride = sizeof(instancedata);
+		size_t first         = 0;
+		auto shapes          = [&](GLuint vao, GLsizei vertices, const std::vector<debugdraw::shape> &batch) {
+			if(batch.empty()) { return; }
+			state.bindvao(vao);
+
+			if(instancing) {
+				const size_t offset = size_t(debugShapeOffset) + first * sizeof(instancedata);
+				GL(glBindBuffer(GL_ARRAY_BUFFER, debugBuffer));
+				for(GLuint c = 0; c < 4; ++c) {
+					GL(glVertexAttribPointer(2 + c, 4, GL_FLOAT, GL_FALSE, stride,
+					                         (GLvoid *)(offset + sizeof(math::point4) * c)));
+					GL(glEnableVertexAttribArray(2 + c));
+					GL(glVertexAttribDivisorARB(2 + c, GLuint(views)));
+				}
+				GL(glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride, (GLvoid *)(offset + sizeof(math::mat4x4))));
+				GL(glEnableVertexAttribArray(1));
+				GL(glVertexAttribDivisorARB(1, GLuint(views)));
+
+				GL(glDrawArraysInstanced(GL_TRIANGLES, 0, vertices, GLsizei(batch.size()) * eyes));
+			} else {
+				for(auto &shape : batch) {
+					constant(shape.transform, shape.color);
+					GL(glDrawArraysInstanced(GL_TRIANGLES, 0, vertices, eyes));
+				}
+			}
+			first += batch.size();
+		};
+
+		if(debugOutlines) { GL(glPolygonMode(GL_FRONT_AND_BACK, GL_LINE)); }
+		shapes(debug_box_vao, GLsizei(debug_box_points.size()), debugBatch.boxes);
+		shapes(debug_ball_vao, GLsizei(debug_ball_points.size()), debugBatch.balls);
+		if(debugOutlines) { GL(glPolygonMode(GL_FRONT_AND_BACK, GL_FILL)); }
+
+		auto &lines  = debugBatch.lines;
+		auto &points = debugBatch.points;
+		if(lines.empty() && points.empty()) { return; }
+
+		const GLsizei vertexStride = sizeof(debugdraw::vertex);
+		const size_t colorOffset   = size_t(debugVertexOffset) + offsetof(debugdraw::vertex, color);
+
+		state.bindvao(debugLineVAO);
+		GL(glBindBuffer(GL_ARRAY_BUFFER, debugBuffer));
+		GL(glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, vertexStride, (GLvoid *)debugVertexOffset));
+		GL(glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, vertexStride, (GLvoid *)colorOffset));
+		constant(math::mat4x4(1), math::point4(1));
+
+		if(!lines.empty()) { GL(glDrawArraysInstanced(GL_LINES, 0, GLsizei(lines.size()), eyes)); }
+		if(!points.empty()) {
+			GL(glPointSize(6));
+			GL(glDrawArraysInstanced(GL_POINTS, GLsizei(lines.size()), GLsizei(points.size()), eyes));
+		}
+	}
+
+	void gl32::bindmaterial(const pipelinenode &node, const drawentry &entry, std::array<unsigned int, 3> texPos) {
+		auto model    = entry.model;
+		auto property = entry.property;
+		auto &locs    = node.locations;
+
+		if(model->asset->material) {
+			if(locs.materialBlock && property->material_ubo != 0) {
+				state.bindubo(GLuint(uniformblock::material), property->material_ubo);
+			} else {
+				auto assetM = engine->get<asset>().lock();
+				auto mat    = assetM->get<polar::asset::material>(*model->asset->material);
+				uploaduniform(locs[uniform::ambient], mat->ambient);
+				uploaduniform(locs[uniform::diffuse], mat->diffuse);
+				uploaduniform(locs[uniform::specular], mat->specular);
+				uploaduniform(locs[uniform::specular_exponent], mat->specular_exponent);
+			}
+		}
+
+		state.bindtexture(texPos[0], property->diffuse_map);
+		uploaduniform(locs[uniform::diffuse_map], glm::int32(texPos[0]));
+
+		state.bindtexture(texPos[1], property->specular_map);
+		uploaduniform(locs[uniform::specular_map], glm::int32(texPos[1]));
+
+		state.bindtexture(texPos[2], property->normal_map);
+		uploaduniform(locs[uniform::normal_map], glm::int32(texPos[2]));
+	}
+
+	void gl32::render(const std::array<math::mat4x4, 2> &projs, math::mat4x4 view) {
+		auto &proj = projs[0];
+		uploadframe(projs, view);
+		auto invViewProj = glm::inverse(proj * view);
+
+		// single-pass stereo instances every scene draw once per eye, clipped at the seam
+		auto eyes = GLsizei(views);
+
+		// with dynamic resolution the pipeline only fills a corner of its targets
+		bool scaled = renderScale < 1;
+		GL(glViewport(0, 0, scaledwidth(), scaledheight()));
 
 		std::unordered_map<std::string, GLuint> globals;
 		for(unsigned int i = 0; i < nodes.size(); ++i) {
 			auto &node = nodes[i];
-			project(node.program, proj);
+			auto &locs = node.locations;
 
-			GL(glBindFramebuffer(GL_FRAMEBUFFER, node.fbo));
-			GL(glUseProgram(node.program));
+			gpu.begin(pipelineNames[i]);
+
+			state.bindfbo(node.fbo);
+			state.useprogram(node.program);
 
 			GL(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
 
-			uploaduniform(node.program, "u_view", view);
-			uploaduniform(node.program, "u_invViewProj", glm::inverse(proj * view));
+			uploaduniform(locs[uniform::instances], glm::int32(i == 0 ? eyes : 1));
+			uploaduniform(locs[uniform::renderScale], math::point2(renderScale));
+
+			// programs without the frame block still take the matrices as plain uniforms, of the left eye in stereo
+			if(!locs.frameBlock) {
+				uploaduniform(locs[uniform::projection], proj);
+				uploaduniform(locs[uniform::view], view);
+				uploaduniform(locs[uniform::invViewProj], invViewProj);
+			}
 
 			unsigned int texPos = 0;
-			GL(glActiveTexture(GL_TEXTURE0 + texPos));
-			GL(glBindTexture(GL_TEXTURE_2D, ditherTex));
+			state.bindtexture(texPos, ditherTex);
 
-			uploaduniform(node.program, "u_ditherTex", glm::int32(texPos));
+			uploaduniform(locs[uniform::ditherTex], glm::int32(texPos));
 			++texPos;
 
 			auto diffuse_pos = texPos;
@@ -331,96 +803,46 @@ namespace polar::system::renderer {
 
 			switch(i) {
 			case 0: {
-				auto ti_range = engine->objects.get<core::index::ti>().equal_range(typeid(component::model));
-				for(auto ti_it = ti_range.first; ti_it != ti_range.second; ++ti_it) {
-					auto model                     = static_cast<component::model *>(ti_it->ptr.get());
-					component::position *pos       = nullptr;
-					component::orientation *orient = nullptr;
-					component::scale *sc           = nullptr;
-
-					auto ref_range = engine->objects.get<core::index::ref>().equal_range(ti_it->r);
-					for(auto ref_it = ref_range.first; ref_it != ref_range.second; ++ref_it) {
-						auto type = ref_it->ti;
-						if(type == typeid(component::position)) {
-							pos = static_cast<component::position *>(ref_it->ptr.get());
-						} else if(type == typeid(component::orientation)) {
-							orient = static_cast<component::orientation *>(ref_it->ptr.get());
-						} else if(type == typeid(component::scale)) {
-							sc = static_cast<component::scale *>(ref_it->ptr.get());
-						}
-					}
-
-					auto property = model->get<model_p>();
-					if(property) {
-						math::mat4x4 modelMatrix(1);
-
-						if(pos != nullptr) { modelMatrix = glm::translate(modelMatrix, pos->pos.temporal(delta)); }
-						if(orient != nullptr) {
-							modelMatrix *= glm::toMat4(glm::inverse(orient->orient.temporal(delta)));
-						}
-						if(sc != nullptr) { modelMatrix = glm::scale(modelMatrix, sc->sc.temporal(delta)); }
-
-						GLenum drawMode = GL_TRIANGLES;
-
-						uploaduniform(node.program, "u_model", modelMatrix);
-
-						if(model->asset->material) {
-							auto mat = assetM->get<polar::asset::material>(*model->asset->material);
-							uploaduniform(node.program, "u_ambient", mat->ambient);
-							uploaduniform(node.program, "u_diffuse", mat->diffuse);
-							uploaduniform(node.program, "u_specular", mat->specular);
-							uploaduniform(node.program, "u_specular_exponent", mat->specular_exponent);
-						}
-
-						GL(glActiveTexture(GL_TEXTURE0 + diffuse_pos));
-						GL(glBindTexture(GL_TEXTURE_2D, property->diffuse_map));
-						uploaduniform(node.program, "u_diffuse_map", glm::int32(diffuse_pos));
-
-						GL(glActiveTexture(GL_TEXTURE0 + specular_pos));
-						GL(glBindTexture(GL_TEXTURE_2D, property->specular_map));
-						uploaduniform(node.program, "u_specular_map", glm::int32(specular_pos));
-
-						GL(glActiveTexture(GL_TEXTURE0 + normal_pos));
-						GL(glBindTexture(GL_TEXTURE_2D, property->normal_map));
-						uploaduniform(node.program, "u_normal_map", glm::int32(normal_pos));
-
-						GL(glBindVertexArray(property->vao));
-						GL(glDrawArrays(drawMode, 0, property->numVertices));
+				std::array<unsigned int, 3> materialPos = {diffuse_pos, specular_pos, normal_pos};
+				state.enable(GL_CLIP_DISTANCE0, eyes > 1);
+
+				gpu.begin("models");
+				if(instancing && node.instanced()) {
+					// one draw per unique model asset, matrices and colours come from the instance buffer
+					for(auto &group : drawgroups) {
+						auto &entry = drawentries[queue[group.first].index];
+						bindmaterial(node, entry, materialPos);
+
+						state.bindvao(entry.property->vao);
+						bindinstances(node, group.first);
+
+						auto &lod = entry.property->lods[entry.lod];
+						GL(glDrawElementsInstanced(GL_TRIANGLES, lod.count, entry.property->indexType, lod.offset,
+						                           GLsizei(group.count) * eyes));
+						++modelDraws;
 					}
-				}
-				if(debug_draw) {
-					GL(glUseProgram(debugProgram));
-
-					project(debugProgram, proj);
-					uploaduniform(debugProgram, "u_view", view);
-
-					for(auto ti_it = ti_range.first; ti_it != ti_range.second; ++ti_it) {
-						auto objectID = ti_it->r;
-						auto phys     = engine->get<component::phys>(objectID);
-						auto pos      = engine->get<component::position>(objectID);
-						auto sc       = engine->get<component::scale>(objectID);
-
-						if(phys != nullptr) {
-							math::mat4x4 modelMatrix(1);
-
-							if(pos != nullptr) { modelMatrix = glm::translate(modelMatrix, pos->pos.temporal(delta)); }
-							if(sc != nullptr) { modelMatrix = glm::scale(modelMatrix, sc->sc.temporal(delta)); }
-							if(phys->detector) { modelMatrix = glm::scale(modelMatrix, phys->detector->size); }
-
-							uploaduniform(debugProgram, "u_model", modelMatrix);
-
-							auto &det = *phys->detector;
-							auto ti   = std::type_index(typeid(det));
-							if(ti == typeid(support::phys::detector::box)) {
-								GL(glBindVertexArray(debug_box_vao));
-								GL(glDrawArrays(GL_TRIANGLES, 0, GLsizei(debug_box_points.size())));
-							} else if(ti == typeid(support::phys::detector::ball)) {
-								GL(glBindVertexArray(debug_ball_vao));
-								GL(glDrawArrays(GL_TRIANGLES, 0, GLsizei(debug_ball_points.size())));
-							}
+				} else {
+					for(auto &packet : queue) {
+						auto e      = packet.index;
+						auto &entry = drawentries[e];
+
+						uploaduniform(locs[uniform::model], transforms[e]);
+						bindmaterial(node, entry, materialPos);
+
+						auto prop = entry.property;
+						auto &lod = prop->lods[entry.lod];
+						state.bindvao(prop->vao);
+						if(eyes > 1) {
+							GL(glDrawElementsInstanced(GL_TRIANGLES, lod.count, prop->indexType, lod.offset, eyes));
+						} else {
+							GL(glDrawElements(GL_TRIANGLES, lod.count, prop->indexType, lod.offset));
 						}
+						++modelDraws;
 					}
 				}
+				gpu.end();
+
+				drawdebug(eyes);
 				break;
 			}
 			default:
@@ -430,60 +852,116 @@ namespace polar::system::renderer {
 				// for each input
 				for(auto &pair : node.ins) {
 					auto buffer = nodes[i - 1].outs[pair.first];
-					GL(glActiveTexture(GL_TEXTURE0 + texPos));
-					GL(glBindTexture(GL_TEXTURE_2D, buffer));
+					state.bindtexture(texPos, buffer);
 
-					uploaduniform(node.program, pair.second, glm::int32(texPos));
+					uploaduniform(locs.find(pair.second), glm::int32(texPos));
 					++texPos;
 				}
 
 				// for each globla input
 				for(auto &pair : node.globalIns) {
 					auto buffer = globals[pair.first];
-					GL(glActiveTexture(GL_TEXTURE0 + texPos));
-					GL(glBindTexture(GL_TEXTURE_2D, buffer));
+					state.bindtexture(texPos, buffer);
 
-					uploaduniform(node.program, pair.second, glm::int32(texPos));
+					uploaduniform(locs.find(pair.second), glm::int32(texPos));
 					++texPos;
 				}
 
-				GL(glBindVertexArray(viewportVAO));
+				state.bindvao(viewportVAO);
 				GL(glDrawArrays(GL_TRIANGLES, 0, GLsizei(viewportPoints.size())));
 
 				break;
 			}
+
+			state.enable(GL_CLIP_DISTANCE0, false);
+			gpu.end();
+		}
+
+		// a scaled frame is stretched onto the window first so the UI stays sharp on top of it
+		if(scaled) {
+			GL(glViewport(0, 0, targetwidth(), height));
+			upscale();
 		}
 
 		// render sprites and text
 		// GL(glEnable(GL_BLEND));
 		{
 			// GL(glBindFramebuffer(GL_FRAMEBUFFER, nodes.back().fbo));
-			GL(glUseProgram(spriteProgram));
-			uploaduniform(spriteProgram, "u_texture", 0);
-			GL(glActiveTexture(GL_TEXTURE0));
-			GL(glBindVertexArray(viewportVAO));
+			gpu.begin("sprites");
+			spriteBatch.clear();
 
 			auto ti_range = engine->objects.get<core::index::ti>().equal_range(typeid(component::sprite::base));
 			for(auto ti_it = ti_range.first; ti_it != ti_range.second; ++ti_it) {
 				rendersprite(ti_it->r, proj, view);
 			}
 
+			drawbatch(spriteAtlas, spriteBatch);
+			gpu.end();
+
+			gpu.begin("text");
+			for(auto &pair : textBatches) { pair.second.clear(); }
+
 			ti_range = engine->objects.get<core::index::ti>().equal_range(typeid(component::text));
 			for(auto ti_it = ti_range.first; ti_it != ti_range.second; ++ti_it) {
 				rendertext(ti_it->r, proj, view);
 			}
+
+			for(auto &pair : textBatches) { drawbatch(fontCache[pair.first].texture, pair.second); }
+			if(showFrameGraph) { drawframegraph(); }
+			gpu.end();
 		}
 		// GL(glDisable(GL_BLEND));
 
+		if(scaled) { return; }
+
 		// mirror
-		GL(glBindFramebuffer(GL_FRAMEBUFFER, 0));
-		GL(glUseProgram(identityProgram));
+		gpu.begin("mirror");
+		state.bindfbo(0);
+		state.useprogram(identityProgram);
 		GL(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
-		GL(glActiveTexture(GL_TEXTURE0));
-		GL(glBindTexture(GL_TEXTURE_2D, nodes.back().outs.at("color")));
-		uploaduniform(identityProgram, "u_colorBuffer", 0);
-		GL(glBindVertexArray(viewportVAO));
+		state.activetexture(0);
+		state.bindtexture(nodes.back().outs.at("color"));
+		uploaduniform(identityLocations[uniform::colorBuffer], 0);
+		state.bindvao(viewportVAO);
 		GL(glDrawArrays(GL_TRIANGLES, 0, GLsizei(viewportPoints.size())));
+		gpu.end();
+	}
+
+	void gl32::upscale() {
+		gpu.begin("mirror");
+		state.bindfbo(0);
+		state.useprogram(upscaleProgram);
+		GL(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+		state.bindtexture(0, nodes.back().outs.at("color"));
+		uploaduniform(upscaleLocations[uniform::texture], glm::int32(0));
+		uploaduniform(upscaleLocations[uniform::renderScale], math::point2(renderScale));
+		uploaduniform(upscaleLocations.find("u_output"), math::point2(targetwidth(), height));
+		state.bindvao(viewportVAO);
+		GL(glDrawArrays(GL_TRIANGLES, 0, GLsizei(viewportPoints.size())));
+		gpu.end();
+	}
+
+	void gl32::updatescale() {
+		// post-process nodes have to take u_renderScale into account, stereo targets are submitted whole
+		if(!dynamicResolution || !scalable || views > 1 || !gpu.active()) {
+			renderScale = 1;
+			return;
+		}
+
+		/* only the pipeline node scopes are summed since only they scale with
+		 * the resolution, the hiz and mirror scopes are opened separately
+		 */
+		float ms = 0;
+		for(auto &name : pipelineNames) { ms += gpu.ms(name); }
+		if(ms <= 0) { return; }
+
+		// fill cost follows the pixel count, so each side scales with the square root of the time ratio
+		auto ideal = renderScale * std::sqrt(targetFrameMs / ms);
+		if(std::abs(ideal - renderScale) < 0.02f) { return; }
+
+		// timings arrive a few frames late, so drop quickly under load but recover gently
+		auto step   = std::clamp(ideal - renderScale, -0.1f, 0.02f);
+		renderScale = std::clamp(renderScale + step, minRenderScale, 1.0f);
 	}
 
 	void gl32::update(DeltaTicks &dt) {
@@ -494,28 +972,28 @@ namespace polar::system::renderer {
 			for(auto &name : changedUniformsU32) {
 				if(node.uniforms.find(name) != node.uniforms.cend()) {
 					if(!usingProgram) {
-						GL(glUseProgram(node.program));
+						state.useprogram(node.program);
 						usingProgram = true;
 					}
-					uploaduniform(node.program, name, uniformsU32[name]);
+					uploaduniform(node.locations.find(name), uniformsU32[name]);
 				}
 			}
 			for(auto &name : changedUniformsFloat) {
 				if(node.uniforms.find(name) != node.uniforms.cend()) {
 					if(!usingProgram) {
-						GL(glUseProgram(node.program));
+						state.useprogram(node.program);
 						usingProgram = true;
 					}
-					uploaduniform(node.program, name, uniformsFloat[name]);
+					uploaduniform(node.locations.find(name), uniformsFloat[name]);
 				}
 			}
 			for(auto &name : changedUniformsPoint3) {
 				if(node.uniforms.find(name) != node.uniforms.cend()) {
 					if(!usingProgram) {
-						GL(glUseProgram(node.program));
+						state.useprogram(node.program);
 						usingProgram = true;
 					}
-					uploaduniform(node.program, name, uniformsPoint3[name]);
+					uploaduniform(node.locations.find(name), uniformsPoint3[name]);
 				}
 			}
 		}
@@ -523,22 +1001,17 @@ namespace polar::system::renderer {
 		changedUniformsFloat.clear();
 		changedUniformsPoint3.clear();
 
-		fps_object = engine->add();
-
-		if(dt.Seconds() > 0) { fps = glm::mix(fps, 1 / dt.Seconds(), math::decimal(0.1)); }
-
-		if(showFPS) {
-			std::ostringstream oss;
-			oss << (int)fps << " fps";
-
-			auto assetM = engine->get<asset>().lock();
-			auto font   = assetM->get<polar::asset::font>("nasalization-rg");
+		// pixel copies run on the workers, only the GL side of an upload happens here
+		auto w = engine->get<work>().lock();
+		textureUploads.update(state, textureBudget, [&w] (std::function<void()> fn) {
+			if(w) {
+				w->do_job(std::move(fn), support::work::job_priority::low, support::work::job_thread::worker);
+			} else {
+				fn();
+			}
+		});
 
-			engine->add<component::text>(fps_object, font, oss.str());
-			engine->add<component::screenposition>(fps_object, math::point2(5, 5), support::ui::origin::topleft);
-			engine->add<component::color>(fps_object, math::point4(1, 1, 1, 0.8));
-			engine->add<component::scale>(fps_object, math::point3(0.125));
-		}
+		updateoverlay(dt);
 
 		auto clock_ref = engine->own<tag::clock::simulation>();
 		auto clock     = engine->add_as<component::clock::base, component::clock::simulation>(clock_ref);
@@ -571,24 +1044,62 @@ namespace polar::system::renderer {
 			if(pos != nullptr) { cameraView = glm::translate(cameraView, -pos->pos.temporal(delta)); }
 		}
 
-		auto vr = engine->get<system::vr>().lock();
-		if(vr && vr->ready()) {
-			using eye = support::vr::eye;
+		using eye = support::vr::eye;
+
+		auto vr     = engine->get<system::vr>().lock();
+		bool stereo = vr && vr->ready();
 
+		// the headset may come and go, or single-pass be toggled from the console
+		if(views != stereoviews()) { maketargets(); }
+
+		math::mat4x4 proj, projLeft, projRight;
+		if(stereo) {
 			vr->update_poses();
 
 			cameraView = glm::transpose(vr->head_view()) * cameraView;
 
-			render(vr->projection(eye::left, zNear, zFar), cameraView, delta);
+			projLeft  = vr->projection(eye::left, zNear, zFar);
+			projRight = vr->projection(eye::right, zNear, zFar);
+			proj      = math::combine_projections(projLeft, projRight, zNear, zFar);
+
+			// the depth of one eye cannot occlude for the other, stereo frames rely on the frustum alone
+			hiz.invalidate();
+			hizPending.fill(false);
+		} else {
+			proj = calculate_projection();
+			collecthiz();
+		}
+
+		updatescale();
+		prepare(delta, cameraView, proj);
+		modelDraws = 0;
+
+		if(stereo && views > 1) {
+			// both halves of one target, each submitted with its own bounds
+			render({projLeft, projRight}, cameraView);
+			auto color = nodes.back().outs.at("color");
+			GL(vr->submit_gl(eye::left, color, 0.0f, 0.5f));
+			GL(vr->submit_gl(eye::right, color, 0.5f, 1.0f));
+			state.invalidate(); // the compositor binds its own state
+		} else if(stereo) {
+			render(projLeft, cameraView);
 			GL(vr->submit_gl(eye::left, nodes.back().outs.at("color")));
-			render(vr->projection(eye::right, zNear, zFar), cameraView, delta);
+			state.invalidate(); // the compositor binds its own state
+			render(projRight, cameraView);
 			GL(vr->submit_gl(eye::right, nodes.back().outs.at("color")));
+			state.invalidate();
 		} else {
-			render(calculate_projection(), cameraView, delta);
+			render(proj, cameraView);
+			capturehiz(proj * cameraView);
 		}
 
 		SDL(SDL_GL_SwapWindow(window));
 
+		stream.endframe();
+		gpu.endframe();
+		state.endframe();
+		log()->trace("gl", "state changes issued: ", state.frame().issued, ", skipped: ", state.frame().skipped);
+
 		// handle input at beginning of frame to reduce delays in other systems
 		SDL_Event event;
 		while(SDL_PollEvent(&event)) { handleSDL(event); }
@@ -712,19 +1223,110 @@ namespace polar::system::renderer {
 		// scale by scale component
 		if(scale) { transform = glm::scale(transform, scale->sc.get()); }
 
-		uploaduniform(spriteProgram, "u_color", color ? color->col.get() : math::point4(1));
+		auto col = glm::vec4(color ? color->col.get() : math::point4(1));
 
-		// scale to sprite size
-		auto sc   = math::point3(sprite->surface->w, sprite->surface->h, 1);
-		transform = glm::scale(transform, sc / math::decimal(2));
+		// same placement as the viewport quad scaled to the sprite size used to have
+		auto w  = math::decimal(sprite->surface->w);
+		auto h  = math::decimal(sprite->surface->h);
+		auto y0 = (offsetY - 1) * h / 2;
 
-		// translate by one sprite size
-		transform = glm::translate(transform, math::point3(1, offsetY, 0));
+		auto corner = [&transform](math::decimal x, math::decimal y) {
+			return glm::vec4(transform * math::point4(x, y, 0, 1));
+		};
+		auto p00 = corner(0, y0), p10 = corner(w, y0), p01 = corner(0, y0 + h), p11 = corner(w, y0 + h);
 
-		uploaduniform(spriteProgram, "u_transform", transform);
+		// surfaces are stored top row first
+		auto t0 = glm::vec2(prop->atlased ? prop->uvMin : math::point2(0));
+		auto t1 = glm::vec2(prop->atlased ? prop->uvMax : math::point2(1));
 
-		GL(glBindTexture(GL_TEXTURE_2D, prop->texture));
-		GL(glDrawArrays(GL_TRIANGLES, 0, GLsizei(viewportPoints.size())));
+		std::array<batchvertex, 6> quad = {
+			batchvertex{p00, glm::vec2(t0.x, t1.y), col}, batchvertex{p10, glm::vec2(t1.x, t1.y), col},
+			batchvertex{p01, glm::vec2(t0.x, t0.y), col}, batchvertex{p01, glm::vec2(t0.x, t0.y), col},
+			batchvertex{p10, glm::vec2(t1.x, t1.y), col}, batchvertex{p11, glm::vec2(t1.x, t0.y), col}};
+
+		if(prop->atlased) {
+			spriteBatch.insert(spriteBatch.end(), quad.begin(), quad.end());
+		} else {
+			drawbatch(prop->texture, std::vector<batchvertex>(quad.begin(), quad.end()));
+		}
+	}
+
+	void gl32::addsprite(component::sprite::base &sprite, sprite_p &prop, bool grow) {
+		if(placesprite(sprite, prop)) {
+			atlasSprites.emplace(&sprite);
+			return;
+		}
+
+		// removed sprites leave holes behind, so reclaim them before growing the atlas
+		for(int size = spritePacker.getwidth(); grow && size <= maxAtlasSize; size *= 2) {
+			repackatlas(size);
+			if(placesprite(sprite, prop)) {
+				atlasSprites.emplace(&sprite);
+				return;
+			}
+		}
+
+		log()->debug("gl", "sprite of ", sprite.surface->w, 'x', sprite.surface->h, " does not fit the atlas");
+
+		prop.atlased = false;
+		GL(glGenTextures(1, &prop.texture));
+		state.bindtexture(prop.texture);
+
+		GLint format = GL_RGBA;
+		GL(glTexImage2D(GL_TEXTURE_2D, 0, format, sprite.surface->w, sprite.surface->h, 0, format, GL_UNSIGNED_BYTE,
+		                sprite.surface->pixels));
+		GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+		GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+		GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+		GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+	}
+
+	bool gl32::placesprite(component::sprite::base &sprite, sprite_p &prop) {
+		auto surface = sprite.surface;
+		auto pos     = spritePacker.pack(surface->w, surface->h);
+		if(!pos) { return false; }
+
+		state.bindtexture(spriteAtlas);
+		GL(glPixelStorei(GL_UNPACK_ROW_LENGTH, surface->pitch / 4));
+		GL(glTexSubImage2D(GL_TEXTURE_2D, 0, pos->x, pos->y, surface->w, surface->h, GL_RGBA, GL_UNSIGNED_BYTE,
+		                   surface->pixels));
+		GL(glPixelStorei(GL_UNPACK_ROW_LENGTH, 0));
+
+		auto size    = math::point2(spritePacker.getwidth(), spritePacker.getheight());
+		prop.atlased = true;
+		prop.uvMin   = math::point2(*pos) / size;
+		prop.uvMax   = math::point2(*pos + math::point2i(surface->w, surface->h)) / size;
+		return true;
+	}
+
+	void gl32::repackatlas(int size) {
+		bool allocate = spriteAtlas == 0 || size != spritePacker.getwidth();
+		if(spriteAtlas == 0) { GL(glGenTextures(1, &spriteAtlas)); }
+		state.bindtexture(spriteAtlas);
+
+		if(allocate) {
+			GL(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL));
+			GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+			GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+			GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+			GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+		}
+		spritePacker = support::gl32::shelfpacker(size, size);
+
+		// tallest first keeps shelves tight
+		std::vector<component::sprite::base *> sprites(atlasSprites.begin(), atlasSprites.end());
+		std::sort(sprites.begin(), sprites.end(), [](auto a, auto b) { return a->surface->h > b->surface->h; });
+
+		for(auto sprite : sprites) {
+			auto prop = sprite->get<sprite_p>();
+			if(!placesprite(*sprite, *prop)) {
+				// cannot happen when growing, kept as a fallback so no sprite is ever lost
+				atlasSprites.erase(sprite);
+				addsprite(*sprite, *prop, false);
+			}
+		}
+
+		log()->debug("gl", "repacked ", atlasSprites.size(), " sprites into ", size, 'x', size, " atlas");
 	}
 
 	void gl32::rendertext(core::weak_ref object, math::mat4x4 proj, math::mat4x4 view) {
@@ -880,32 +1482,249 @@ namespace polar::system::renderer {
 		// scale by scale component
 		if(scale) { transform = glm::scale(transform, scale->sc.get()); }
 
-		uploaduniform(spriteProgram, "u_color", color ? color->col.get() : math::point4(1));
+		auto prop = text->get<text_p>();
+		if(!prop) {
+			text->add<text_p>();
+			prop = text->get<text_p>();
+		}
+		if(prop->str != text->str || prop->offsetY != offsetY) { buildtext(*text, *prop, offsetY); }
+
+		auto col    = glm::vec4(color ? color->col.get() : math::point4(1));
+		auto &batch = textBatches[text->as];
+		for(auto &v : prop->vertices) {
+			auto position = transform * math::point4(v.position.x, v.position.y, 0, 1);
+			batch.emplace_back(batchvertex{glm::vec4(position), glm::vec2(v.texcoord), col});
+		}
+	}
+
+	void gl32::buildtext(const component::text &text, text_p &prop, math::decimal offsetY) {
+		auto &cache = fontCache[text.as];
+
+		prop.str     = text.str;
+		prop.offsetY = offsetY;
+		prop.vertices.clear();
+		prop.vertices.reserve(text.str.size() * 6);
 
 		math::decimal pen = 0;
-		for(auto c : text->str) {
-			math::mat4x4 glyphTransform = transform;
+		for(auto c : text.str) {
+			auto &glyph = text.as->glyphs[c];
+			auto &entry = cache.entries[c];
+
+			if(glyph.surface != nullptr && entry.active) {
+				// same placement as one viewport quad scaled to the glyph used to have
+				auto w  = math::decimal(glyph.surface->w);
+				auto h  = math::decimal(glyph.surface->h);
+				auto x0 = pen + glyph.min.x;
+				auto x1 = x0 + w;
+				auto y0 = (offsetY - 1) * h / 2;
+				auto y1 = y0 + h;
+
+				// surfaces are stored top row first
+				auto &t0 = entry.uvMin;
+				auto &t1 = entry.uvMax;
+
+				prop.vertices.emplace_back(text_p::vertex{math::point2(x0, y0), math::point2(t0.x, t1.y)});
+				prop.vertices.emplace_back(text_p::vertex{math::point2(x1, y0), math::point2(t1.x, t1.y)});
+				prop.vertices.emplace_back(text_p::vertex{math::point2(x0, y1), math::point2(t0.x, t0.y)});
+				prop.vertices.emplace_back(text_p::vertex{math::point2(x0, y1), math::point2(t0.x, t0.y)});
+				prop.vertices.emplace_back(text_p::vertex{math::point2(x1, y0), math::point2(t1.x, t1.y)});
+				prop.vertices.emplace_back(text_p::vertex{math::point2(x1, y1), math::point2(t1.x, t0.y)});
+			}
 
-			// translate by glyph pen
-			glyphTransform = glm::translate(glyphTransform, math::point3(pen, 0, 0));
+			pen += glyph.advance;
+		}
+	}
 
-			// translate by glyph min x
-			glyphTransform = glm::translate(glyphTransform, math::point3(text->as->glyphs[c].min.x, 0, 0));
+	void gl32::cachefont(const std::shared_ptr<polar::asset::font> &font) {
+		auto &cache = fontCache[font];
+		if(cache.texture != 0) { return; }
+
+		// tallest first keeps shelves tight
+		std::vector<size_t> order;
+		int area = 0, widest = 0;
+		for(size_t c = 0; c < font->glyphs.size(); ++c) {
+			auto surface = font->glyphs[c].surface;
+			if(font->glyphs[c].active && surface != nullptr) {
+				order.emplace_back(c);
+				area += (surface->w + 1) * (surface->h + 1);
+				widest = std::max(widest, surface->w + 1);
+			}
+		}
+		std::sort(order.begin(), order.end(), [&font](size_t a, size_t b) {
+			return font->glyphs[a].surface->h > font->glyphs[b].surface->h;
+		});
+
+		int side = 64;
+		while(side * side < area || side < widest) { side *= 2; }
+
+		// grow the atlas height until every glyph fits
+		std::vector<math::point2i> positions(font->glyphs.size());
+		support::gl32::shelfpacker packer(side, side);
+		for(bool packed = false; !packed;) {
+			packed = true;
+			for(auto c : order) {
+				auto surface = font->glyphs[c].surface;
+				auto pos     = packer.pack(surface->w, surface->h);
+				if(!pos) {
+					packed = false;
+					packer = support::gl32::shelfpacker(side, packer.getheight() * 2);
+					break;
+				}
+				positions[c] = *pos;
+			}
+		}
+
+		cache.size = math::point2i(side, packer.getheight());
+
+		GL(glGenTextures(1, &cache.texture));
+		state.bindtexture(cache.texture);
 
-			// scale to glyph size
-			auto sc        = math::point3(text->as->glyphs[c].surface->w, text->as->glyphs[c].surface->h, 1);
-			glyphTransform = glm::scale(glyphTransform, sc / math::decimal(2));
+		GL(glPixelStorei(GL_UNPACK_ALIGNMENT, 4));
+		GL(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, cache.size.x, cache.size.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL));
 
-			// translate by one glyph size
-			glyphTransform = glm::translate(glyphTransform, math::point3(1, offsetY, 0));
+		// clear the padding so filtering never samples garbage
+		std::vector<uint8_t> zeroes(size_t(cache.size.x) * cache.size.y * 4, 0);
+		GL(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, cache.size.x, cache.size.y, GL_RGBA, GL_UNSIGNED_BYTE,
+		                   zeroes.data()));
 
-			uploaduniform(spriteProgram, "u_transform", glyphTransform);
+		auto texel = math::point2(1) / math::point2(cache.size);
+		for(auto c : order) {
+			auto surface = font->glyphs[c].surface;
+			auto pos     = positions[c];
 
-			GL(glBindTexture(GL_TEXTURE_2D, fontCache[text->as].entries[c].texture));
-			GL(glDrawArrays(GL_TRIANGLES, 0, GLsizei(viewportPoints.size())));
+			GL(glPixelStorei(GL_UNPACK_ROW_LENGTH, surface->pitch / 4));
+			GL(glTexSubImage2D(GL_TEXTURE_2D, 0, pos.x, pos.y, surface->w, surface->h, GL_RGBA, GL_UNSIGNED_BYTE,
+			                   surface->pixels));
 
-			pen += text->as->glyphs[c].advance;
+			auto &entry  = cache.entries[c];
+			entry.active = true;
+			entry.uvMin  = math::point2(pos) * texel;
+			entry.uvMax  = math::point2(pos + math::point2i(surface->w, surface->h)) * texel;
 		}
+		GL(glPixelStorei(GL_UNPACK_ROW_LENGTH, 0));
+
+		GL(glGenerateMipmap(GL_TEXTURE_2D));
+		GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+		GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+		GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+		GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST));
+
+		log()->debug("gl", "packed ", order.size(), " glyphs into ", cache.size.x, 'x', cache.size.y, " atlas");
+	}
+
+	void gl32::updateoverlay(DeltaTicks &dt) {
+		if(dt.Seconds() > 0) { fps = glm::mix(fps, 1 / dt.Seconds(), math::decimal(0.1)); }
+
+		frameTimes[frameTimeHead] = dt.Seconds() * 1000;
+		frameTimeHead             = (frameTimeHead + 1) % frameGraphSize;
+
+		if(showFPS) {
+			if(!fpsText) {
+				auto assetM = engine->get<asset>().lock();
+				auto font   = assetM->get<polar::asset::font>("nasalization-rg");
+
+				fps_object = engine->add();
+				fpsText    = engine->add<component::text>(fps_object, font, "");
+				engine->add<component::screenposition>(fps_object, math::point2(5, 5), support::ui::origin::topleft);
+				engine->add<component::color>(fps_object, math::point4(1, 1, 1, 0.8));
+				engine->add<component::scale>(fps_object, math::point3(0.125));
+			}
+
+			// the text property only rebuilds its quads when the string actually changes
+			auto str = std::to_string(int(fps)) + " fps";
+			if(fpsText->str != str) { fpsText->str = str; }
+		} else if(fpsText) {
+			fpsText.reset();
+			fps_object = core::ref();
+		}
+	}
+
+	void gl32::drawframegraph() {
+		const math::decimal barWidth = 2;
+		const math::decimal maxMs    = 50;
+		const math::decimal graphH   = 100;
+		const math::point2 origin(5, 5);
+
+		auto toclip = [this](math::decimal x, math::decimal y) {
+			return glm::vec4(x / width * 2 - 1, y / height * 2 - 1, 0, 1);
+		};
+		auto quad = [this, &toclip](math::decimal x0, math::decimal y0, math::decimal x1, math::decimal y1,
+		                            glm::vec4 col) {
+			overlayVertices.emplace_back(batchvertex{toclip(x0, y0), glm::vec2(0), col});
+			overlayVertices.emplace_back(batchvertex{toclip(x1, y0), glm::vec2(0), col});
+			overlayVertices.emplace_back(batchvertex{toclip(x0, y1), glm::vec2(0), col});
+			overlayVertices.emplace_back(batchvertex{toclip(x0, y1), glm::vec2(0), col});
+			overlayVertices.emplace_back(batchvertex{toclip(x1, y0), glm::vec2(0), col});
+			overlayVertices.emplace_back(batchvertex{toclip(x1, y1), glm::vec2(0), col});
+		};
+
+		overlayVertices.clear();
+
+		// oldest frame on the left
+		for(size_t i = 0; i < frameGraphSize; ++i) {
+			auto ms = frameTimes[(frameTimeHead + i) % frameGraphSize];
+			auto h  = std::min(ms, maxMs) / maxMs * graphH;
+			auto x  = origin.x + i * barWidth;
+
+			glm::vec4 col(0.2, 0.9, 0.2, 0.8);
+			if(ms > 1000.0f / 30) {
+				col = glm::vec4(0.9, 0.2, 0.2, 0.8);
+			} else if(ms > 1000.0f / 60) {
+				col = glm::vec4(0.9, 0.8, 0.2, 0.8);
+			}
+			quad(x, origin.y, x + barWidth - 0.5f, origin.y + h, col);
+		}
+
+		// 60 Hz budget line
+		auto budget = (1000.0f / 60) / maxMs * graphH;
+		quad(origin.x, origin.y + budget, origin.x + frameGraphSize * barWidth, origin.y + budget + 1,
+		     glm::vec4(1, 1, 1, 0.5));
+
+		drawbatch(whiteTex, overlayVertices);
+	}
+
+	void gl32::drawbatch(GLuint texture, const std::vector<batchvertex> &vertices) {
+		if(vertices.empty()) { return; }
+
+		GLsizeiptr size = vertices.size() * sizeof(batchvertex);
+		auto alloc      = stream.map(size, sizeof(batchvertex));
+		std::memcpy(alloc.ptr, vertices.data(), size_t(size));
+		stream.unmap();
+
+		state.useprogram(batchProgram);
+		bindbatch();
+		state.bindtexture(0, texture);
+		uploaduniform(batchLocations[uniform::texture], 0);
+
+		auto first = GLint(alloc.offset / GLintptr(sizeof(batchvertex)));
+		if(views == 1) {
+			GL(glDrawArrays(GL_TRIANGLES, first, GLsizei(vertices.size())));
+			return;
+		}
+
+		// the batch shader knows nothing of stereo, so each view gets its own viewport
+		for(size_t v = 0; v < views; ++v) {
+			GL(glViewport(GLint(v) * GLint(width), 0, width, height));
+			GL(glDrawArrays(GL_TRIANGLES, first, GLsizei(vertices.size())));
+		}
+		GL(glViewport(0, 0, targetwidth(), height));
+	}
+
+	void gl32::bindbatch() {
+		state.bindvao(batchVAO);
+
+		// the stream replaces its buffer when it grows, so the pointers follow it
+		if(batchBuffer == stream.name()) { return; }
+		batchBuffer = stream.name();
+
+		const GLsizei stride = sizeof(batchvertex);
+		GL(glBindBuffer(GL_ARRAY_BUFFER, batchBuffer));
+		GL(glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, stride, (GLvoid *)offsetof(batchvertex, position)));
+		GL(glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (GLvoid *)offsetof(batchvertex, texcoord)));
+		GL(glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, stride, (GLvoid *)offsetof(batchvertex, color)));
+		GL(glEnableVertexAttribArray(0));
+		GL(glEnableVertexAttribArray(1));
+		GL(glEnableVertexAttribArray(2));
 	}
 
 	gl32::~gl32() {
@@ -1008,40 +1827,114 @@ namespace polar::system::renderer {
 	void gl32::makepipeline(const std::vector<std::string> &names) {
 		pipelineNames = names;
 
+		auto started = std::chrono::steady_clock::now();
+
 		auto assetM = engine->get<asset>().lock();
-		std::vector<std::shared_ptr<polar::asset::shaderprogram>> assets;
-		for(auto &node : nodes) {
-			for(auto &out : node.globalOuts) { GL(glDeleteTextures(1, &out.second)); }
-			for(auto &out : node.outs) { GL(glDeleteTextures(1, &out.second)); }
-			GL(glDeleteFramebuffers(1, &node.fbo));
-			GL(glDeleteProgram(node.program));
-		}
+		for(auto &node : nodes) { GL(glDeleteProgram(node.program)); }
+		droptargets();
 		nodes.clear();
+		pipelineAssets.clear();
+
+		// deleted names may be handed out again by the driver
+		state.invalidate();
 
 		for(auto &name : names) {
 			log()->verbose("gl", "building shader program `", name, '`');
 			auto as = assetM->get<polar::asset::shaderprogram>(name);
-			assets.emplace_back(as);
+			pipelineAssets.emplace_back(as);
 			nodes.emplace_back(makeprogram(as));
 			for(auto &uniform : as->uniforms) { nodes.back().uniforms.emplace(uniform); }
+
+			auto &node     = nodes.back();
+			node.locations = resolveuniforms(node.program, as->uniforms);
+			GL(node.instanceModelLoc = glGetAttribLocation(node.program, "a_instanceModel"));
+			GL(node.instanceColorLoc = glGetAttribLocation(node.program, "a_instanceColor"));
+		}
+
+		for(size_t i = 0; i + 1 < nodes.size(); ++i) {
+			auto &nextAsset = pipelineAssets[i + 1];
+			auto &nextNode  = nodes[i + 1];
+
+			for(auto &in : nextAsset->ins) {
+				auto &outs = pipelineAssets[i]->outs;
+				auto it    = std::find_if(outs.begin(), outs.end(), [&in] (auto &out) { return out.key == in.key; });
+				if(it == outs.end()) { log()->fatal("gl", "failed to connect nodes (invalid key `" + in.key + "`)"); }
+				nextNode.ins.emplace(in.key, in.name);
+			}
+
+			for(auto &in : nextAsset->globalIns) { nextNode.globalIns.emplace(in.key, in.name); }
+		}
+
+		for(auto &node : nodes) {
+			// inputs are only known once the whole pipeline is linked
+			for(auto &in : node.ins) {
+				GL(node.locations.named[in.second] = glGetUniformLocation(node.program, in.second.c_str()));
+			}
+			for(auto &in : node.globalIns) {
+				GL(node.locations.named[in.second] = glGetUniformLocation(node.program, in.second.c_str()));
+			}
 		}
 
+		for(auto uniform : uniformsU32) { setuniform(uniform.first, uniform.second, true); }
+		for(auto uniform : uniformsFloat) { setuniform(uniform.first, uniform.second, true); }
+		for(auto uniform : uniformsPoint3) { setuniform(uniform.first, uniform.second, true); }
+
+		// nodes sampling earlier outputs must know which part of them was rendered to
+		scalable = true;
+		for(size_t i = 1; i < nodes.size(); ++i) {
+			if(nodes[i].locations[uniform::renderScale] == -1) {
+				log()->verbose("gl", "program `", names[i], "` ignores u_renderScale, dynamic resolution disabled");
+				scalable = false;
+			}
+		}
+
+		maketargets();
+
+		auto elapsed = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - started);
+		log()->verbose("gl", "pipeline built in ", elapsed.count(), " ms");
+	}
+
+	size_t gl32::stereoviews() {
+		auto vr = engine->get<system::vr>().lock();
+		return singlePassStereo && vr && vr->ready() ? 2 : 1;
+	}
+
+	void gl32::droptargets() {
+		for(auto &node : nodes) {
+			for(auto &out : node.globalOuts) { GL(glDeleteTextures(1, &out.second)); }
+			for(auto &out : node.outs) { GL(glDeleteTextures(1, &out.second)); }
+			if(node.fbo != 0) { GL(glDeleteFramebuffers(1, &node.fbo)); }
+			node.globalOuts.clear();
+			node.outs.clear();
+			node.fbo      = 0;
+			node.depthOut = 0;
+		}
+	}
+
+	void gl32::maketargets() {
+		droptargets();
+		state.invalidate();
+
+		// single-pass stereo renders both eyes side by side into targets twice as wide
+		views = stereoviews();
+		GL(glViewport(0, 0, targetwidth(), height));
+
 		for(unsigned int i = 0; i < nodes.size(); ++i) {
-			auto &as   = assets[i];
+			auto &as   = pipelineAssets[i];
 			auto &node = nodes[i];
 
 			std::vector<GLenum> drawBuffers;
 			int colorAttachment = 0;
 
 			GL(glGenFramebuffers(1, &node.fbo));
-			GL(glBindFramebuffer(GL_FRAMEBUFFER, node.fbo));
+			state.bindfbo(node.fbo);
 
 			auto fOut = [this, &drawBuffers, &colorAttachment](polar::asset::shaderoutput &out) {
 				using outputtype = support::shader::outputtype;
 
 				GLuint texture;
 				GL(glGenTextures(1, &texture));
-				GL(glBindTexture(GL_TEXTURE_2D, texture));
+				state.bindtexture(texture);
 
 				GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
 				GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
@@ -1105,29 +1998,18 @@ namespace polar::system::renderer {
 					drawBuffers.emplace_back(attachment);
 				}
 
-				GL(glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, NULL));
+				GL(glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, targetwidth(), height, 0, format, type, NULL));
 				GL(glFramebufferTexture(GL_FRAMEBUFFER, attachment, texture, 0));
 
 				return texture;
 			};
 
-			for(auto &out : as->outs) { node.outs.emplace(out.key, fOut(out)); }
-			for(auto &out : as->globalOuts) { node.globalOuts.emplace(out.key, fOut(out)); }
-
-			if(i < nodes.size() - 1) {
-				auto &nextAsset = assets[i + 1];
-				auto &nextNode  = nodes[i + 1];
-
-				for(auto &in : nextAsset->ins) {
-					auto it = node.outs.find(in.key);
-					if(it == node.outs.end()) {
-						log()->fatal("gl", "failed to connect nodes (invalid key `" + in.key + "`)");
-					}
-					nextNode.ins.emplace(in.key, in.name);
-				}
-
-				for(auto &in : nextAsset->globalIns) { nextNode.globalIns.emplace(in.key, in.name); }
+			for(auto &out : as->outs) {
+				auto texture = fOut(out);
+				node.outs.emplace(out.key, texture);
+				if(out.type == support::shader::outputtype::depth) { node.depthOut = texture; }
 			}
+			for(auto &out : as->globalOuts) { node.globalOuts.emplace(out.key, fOut(out)); }
 
 			GL(glDrawBuffers(static_cast<GLsizei>(drawBuffers.size()), drawBuffers.data()));
 
@@ -1148,19 +2030,134 @@ namespace polar::system::renderer {
 
 		for(auto &node : nodes) {
 			// upload projection matrix to pipeline stage
-			project(node.program);
+			project(node.program, node.locations);
 			// upload resolution
-			uploaduniform(node.program, "u_resolution", math::point2(width, height));
+			uploaduniform(node.locations[uniform::resolution], math::point2(targetwidth(), height));
 		}
 
-		for(auto uniform : uniformsU32) { setuniform(uniform.first, uniform.second, true); }
-		for(auto uniform : uniformsFloat) { setuniform(uniform.first, uniform.second, true); }
-		for(auto uniform : uniformsPoint3) { setuniform(uniform.first, uniform.second, true); }
+		makehiz();
+	}
+
+	void gl32::makehiz() {
+		if(hizFBO != 0) {
+			GL(glDeleteFramebuffers(1, &hizFBO));
+			GL(glDeleteTextures(1, &hizTex));
+			GL(glDeleteBuffers(GLsizei(hizSlots), hizPBOs.data()));
+			state.invalidate();
+		}
+
+		// captures of the old size are useless now
+		hiz.invalidate();
+		hizPending.fill(false);
+
+		hizHeight = std::max(1, int(hizWidth * height / std::max(1, int(width))));
+
+		GL(glGenTextures(1, &hizTex));
+		state.bindtexture(hizTex);
+		GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+		GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+		GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+		GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+		GL(glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, hizWidth, hizHeight, 0, GL_RED, GL_FLOAT, NULL));
+
+		GL(glGenFramebuffers(1, &hizFBO));
+		state.bindfbo(hizFBO);
+		GL(glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, hizTex, 0));
+
+		GLenum status;
+		GL(status = glCheckFramebufferStatus(GL_FRAMEBUFFER));
+		if(status != GL_FRAMEBUFFER_COMPLETE) {
+			log()->warning("gl", "hierarchical depth framebuffer incomplete, disabling occlusion culling");
+			occlusion = false;
+		}
+
+		GL(glGenBuffers(GLsizei(hizSlots), hizPBOs.data()));
+		for(auto pbo : hizPBOs) {
+			GL(glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo));
+			GL(glBufferData(GL_PIXEL_PACK_BUFFER, hizWidth * hizHeight * sizeof(float), NULL, GL_STREAM_READ));
+		}
+		GL(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+	}
+
+	void gl32::capturehiz(const math::mat4x4 &viewProj) {
+		if(!occlusion || nodes.empty() || nodes[0].depthOut == 0) { return; }
+
+		// only the scaled corner of the depth target was rendered to
+		auto slot        = hizSlot;
+		GLint extentX    = scaledwidth();
+		GLint extentY    = scaledheight();
+		GLint footprintX = (extentX + hizWidth - 1) / hizWidth;
+		GLint footprintY = (extentY + hizHeight - 1) / hizHeight;
+
+		gpu.begin("hiz");
+		state.bindfbo(hizFBO);
+		state.enable(GL_BLEND, false);
+		GL(glViewport(0, 0, hizWidth, hizHeight));
+
+		state.useprogram(hizProgram);
+		state.bindtexture(0, nodes[0].depthOut);
+		uploaduniform(hizLocations[uniform::texture], glm::int32(0));
+		GL(glUniform2i(hizLocations.find("u_footprint"), footprintX, footprintY));
+		GL(glUniform2i(hizLocations.find("u_extent"), extentX, extentY));
+
+		state.bindvao(viewportVAO);
+		GL(glDrawArrays(GL_TRIANGLES, 0, GLsizei(viewportPoints.size())));
+
+		// the copy into the PBO is queued, it is mapped a frame later once the GPU is done with it
+		GL(glBindBuffer(GL_PIXEL_PACK_BUFFER, hizPBOs[slot]));
+		GL(glReadPixels(0, 0, hizWidth, hizHeight, GL_RED, GL_FLOAT, NULL));
+		GL(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+
+		// fenced so collecthiz can tell whether the copy is done without waiting on it
+		if(hizFences[slot]) { GL(glDeleteSync(hizFences[slot])); }
+		hizFences[slot] = nullptr;
+		if(GLEW_VERSION_3_2 || GLEW_ARB_sync) {
+			GL(hizFences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+		}
+
+		GL(glViewport(0, 0, targetwidth(), height));
+		state.enable(GL_BLEND, true);
+		gpu.end();
+
+		hizViewProj[slot] = viewProj;
+		hizPending[slot]  = true;
+		hizSlot           = (slot + 1) % hizSlots;
+	}
+
+	void gl32::collecthiz() {
+		// the slot about to be overwritten holds the oldest capture
+		auto slot = hizSlot;
+		if(!hizPending[slot]) { return; }
+		hizPending[slot] = false;
+
+		// mapping a copy the GPU has not finished would stall, so keep the previous pyramid instead
+		if(auto fence = hizFences[slot]) {
+			GLenum result;
+			GL(result = glClientWaitSync(fence, 0, 0));
+			GL(glDeleteSync(fence));
+			hizFences[slot] = nullptr;
+			if(result == GL_TIMEOUT_EXPIRED || result == GL_WAIT_FAILED) { return; }
+		}
+
+		GLsizeiptr size = hizWidth * hizHeight * sizeof(float);
+		GL(glBindBuffer(GL_PIXEL_PACK_BUFFER, hizPBOs[slot]));
+
+		const float *data;
+		GL(data = static_cast<const float *>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT)));
+		if(data != nullptr) {
+			hiz.build(data, hizWidth, hizHeight, hizViewProj[slot]);
+			GL(glUnmapBuffer(GL_PIXEL_PACK_BUFFER));
+		}
+
+		GL(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
 	}
 
 	GLuint gl32::makeprogram(std::shared_ptr<polar::asset::shaderprogram> as) {
 		using shadertype = support::shader::shadertype;
 
+		auto key = programs.key(*as);
+		if(auto cached = programs.load(key)) { return cached; }
+
 		std::vector<GLuint> ids;
 		for(auto &shader : as->shaders) {
 			GLenum type = 0;
@@ -1218,6 +2215,7 @@ namespace polar::system::renderer {
 			if(!GL(glDeleteShader(id))) { log()->fatal("gl", "failed to flag shader for deletion"); }
 		}
 
+		programs.hint(programID);
 		if(!GL(glLinkProgram(programID))) { log()->fatal("gl", "program linking is unsupported on this platform"); }
 
 		GLint status;
@@ -1241,27 +2239,100 @@ namespace polar::system::renderer {
 			}
 			log()->fatal("gl", "failed to link program");
 		}
+
+		programs.store(programID, key);
 		return programID;
 	}
 
-	std::shared_ptr<gl32::model_p> gl32::getpooledmodelproperty(const GLsizei) {
-		if(modelPropertyPool.empty()) {
-			model_p prop;
+	gl32::uniformcache gl32::resolveuniforms(GLuint program, const std::vector<std::string> &names) {
+		uniformcache cache;
 
-			GL(glGenVertexArrays(1, &prop.vao));
-			GL(glBindVertexArray(prop.vao));
+		for(size_t u = 0; u < size_t(uniform::count); ++u) {
+			GL(cache.locations[u] = glGetUniformLocation(program, support::gl32::uniformname(uniform(u))));
+		}
+		for(auto &name : names) {
+			GLint loc;
+			GL(loc = glGetUniformLocation(program, name.c_str()));
+			cache.named.emplace(name, loc);
+		}
 
-			/* location   attribute
-			 *
-			 *        0   vertex
-			 *        1   normal
-			 */
+		auto bindblock = [program](uniformblock block) {
+			GLuint index;
+			GL(index = glGetUniformBlockIndex(program, support::gl32::blockname(block)));
+			if(index == GL_INVALID_INDEX) { return false; }
 
-			prop.vbos.resize(1);
-			GL(glGenBuffers(1, &prop.vbos[0]));
+			GL(glUniformBlockBinding(program, index, GLuint(block)));
+			return true;
+		};
+		cache.frameBlock    = bindblock(uniformblock::frame);
+		cache.materialBlock = bindblock(uniformblock::material);
+
+		return cache;
+	}
+
+	std::shared_ptr<gl32::model_p> gl32::getpooledmodelproperty(GLsizeiptr vertexBytes, GLsizeiptr indexBytes) {
+		/* best fit, the smallest pooled buffers holding the mesh without growing
+		 * are taken, but a tiny mesh never ties up storage more than two size
+		 * classes larger than it needs
+		 */
+		auto limit = sizeclass(vertexBytes) * 4;
+		for(auto it = modelPropertyPool.lower_bound(vertexBytes);
+		    it != modelPropertyPool.end() && it->first <= limit; ++it) {
+			if(it->second->indexBytes >= indexBytes) {
+				auto prop = it->second;
+				modelPropertyPool.erase(it);
+				return prop;
+			}
+		}
 
+		model_p prop;
+
+		GL(glGenVertexArrays(1, &prop.vao));
+		state.bindvao(prop.vao);
+
+		prop.vbos.resize(1);
+		GL(glGenBuffers(1, &prop.vbos[0]));
+
+		// the element buffer binding is part of the VAO state
+		GL(glGenBuffers(1, &prop.ebo));
+		GL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, prop.ebo));
+
+		// storage is sized to a whole class up front so the buffers can be reused by similar meshes later
+		prop.capacity   = sizeclass(vertexBytes);
+		prop.indexBytes = sizeclass(indexBytes);
+		if(prop.capacity > 0) {
 			GL(glBindBuffer(GL_ARRAY_BUFFER, prop.vbos[0]));
+			GL(glBufferData(GL_ARRAY_BUFFER, prop.capacity, NULL, GL_DYNAMIC_DRAW));
+		}
+		if(prop.indexBytes > 0) {
+			GL(glBufferData(GL_ELEMENT_ARRAY_BUFFER, prop.indexBytes, NULL, GL_DYNAMIC_DRAW));
+		}
+
+		log()->trace("gl", "allocated model buffers (", prop.capacity, " + ", prop.indexBytes, " bytes)");
+		return std::make_shared<model_p>(prop);
+	}
+
+	void gl32::setvertexlayout(model_p &prop, bool compact) {
+		state.bindvao(prop.vao);
+		GL(glBindBuffer(GL_ARRAY_BUFFER, prop.vbos[0]));
+
+		/* location   attribute
+		 *
+		 *        0   vertex
+		 *        1   normal
+		 *        2   texcoord
+		 */
 
+		if(compact) {
+			const GLsizei stride = sizeof(polar::asset::packedvertex);
+			const GLvoid *p_ptr  = (GLvoid *)offsetof(polar::asset::packedvertex, position);
+			const GLvoid *n_ptr  = (GLvoid *)offsetof(polar::asset::packedvertex, normal);
+			const GLvoid *t_ptr  = (GLvoid *)offsetof(polar::asset::packedvertex, texcoord);
+
+			GL(glVertexAttribPointer(0, 3, GL_SHORT, GL_TRUE, stride, p_ptr));
+			GL(glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, n_ptr));
+			GL(glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, stride, t_ptr));
+		} else {
 			const GLsizei stride = sizeof(polar::asset::vertex);
 			const GLvoid *p_ptr  = NULL;
 			const GLvoid *n_ptr  = (GLvoid *)sizeof(math::point3);
@@ -1270,95 +2341,190 @@ namespace polar::system::renderer {
 			GL(glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, p_ptr));
 			GL(glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, n_ptr));
 			GL(glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, t_ptr));
+		}
 
-			GL(glEnableVertexAttribArray(0));
-			GL(glEnableVertexAttribArray(1));
-			GL(glEnableVertexAttribArray(2));
+		GL(glEnableVertexAttribArray(0));
+		GL(glEnableVertexAttribArray(1));
+		GL(glEnableVertexAttribArray(2));
 
-			return std::make_shared<model_p>(prop);
-		} else {
-			auto it   = modelPropertyPool.begin();
-			auto prop = *it;
-			modelPropertyPool.erase(it);
-			return prop;
-		}
+		prop.compact = compact;
 	}
 
 	void gl32::uploadmodel(std::shared_ptr<component::model> model) {
+		// components sharing a model asset share its buffers, textures and material block
+		auto &prop = meshCache.acquire(model->asset.get(), [this, &model] { return makemesh(model); });
+		model->add<model_p>(prop);
+	}
+
+	std::pair<std::shared_ptr<gl32::model_p>, size_t> gl32::makemesh(std::shared_ptr<component::model> model) {
 		model->generate_normals();
 
-		GLsizei count   = GLsizei(model->asset->triangles.size()) * 3;
-		GLsizeiptr size = model->asset->triangles.size() * sizeof(polar::asset::triangle);
-		void *data      = model->asset->triangles.data();
-		auto prop       = getpooledmodelproperty(count);
+		auto &mesh = *model->asset;
 
-		if(count > 0) {
-			if(count > prop->capacity) {
-				GL(glBindBuffer(GL_ARRAY_BUFFER, prop->vbos[0]));
-				GL(glBufferData(GL_ARRAY_BUFFER, size, data, GL_DYNAMIC_DRAW));
+		// every level of detail indexes the same vertices, so they follow the full mesh in one element buffer
+		std::vector<uint32_t> indices(mesh.indices);
+		for(auto &lod : mesh.lods) { indices.insert(indices.end(), lod.indices.begin(), lod.indices.end()); }
 
-				prop->capacity = count;
-			} else {
-				GL(glBindBuffer(GL_ARRAY_BUFFER, prop->vbos[0]));
-				GL(glBufferSubData(GL_ARRAY_BUFFER, 0, size, data));
-			}
+		// drivers without packed normals get the compact mesh expanded back to floats
+		std::vector<polar::asset::vertex> expanded;
+		bool compact = mesh.compact() && packedNormals;
+		if(mesh.compact() && !compact) {
+			support::mesh::dequantize(mesh.packed, mesh.center, mesh.extent, expanded);
+		}
+		auto &vertices = expanded.empty() ? mesh.vertices : expanded;
+
+		GLsizei count    = GLsizei(compact ? mesh.packed.size() : vertices.size());
+		GLsizeiptr size  = count * (compact ? sizeof(polar::asset::packedvertex) : sizeof(polar::asset::vertex));
+		const void *data = compact ? (const void *)mesh.packed.data() : (const void *)vertices.data();
+
+		// halve index bandwidth for meshes that fit in 16 bits
+		std::vector<uint16_t> shortIndices;
+		GLenum indexType      = GL_UNSIGNED_INT;
+		GLsizeiptr indexSize  = indices.size() * sizeof(uint32_t);
+		const void *indexData = indices.data();
+		if(count <= 0x10000) {
+			shortIndices.assign(indices.begin(), indices.end());
+			indexType = GL_UNSIGNED_SHORT;
+			indexSize = shortIndices.size() * sizeof(uint16_t);
+			indexData = shortIndices.data();
+		}
+
+		// pooled buffers always have room, so uploads never reallocate
+		auto prop = getpooledmodelproperty(size, indexSize);
+
+		setvertexlayout(*prop, compact);
+		if(compact) {
+			prop->dequantize = glm::scale(glm::translate(math::mat4x4(1), mesh.center), math::point3(mesh.extent));
+		} else {
+			prop->dequantize = math::mat4x4(1);
+		}
+
+		if(size > 0) {
+			GL(glBindBuffer(GL_ARRAY_BUFFER, prop->vbos[0]));
+			GL(glBufferSubData(GL_ARRAY_BUFFER, 0, size, data));
+		}
+
+		if(indexSize > 0) {
+			// the VAO owns the element binding so bind it before touching the buffer
+			state.bindvao(prop->vao);
+			GL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, prop->ebo));
+			GL(glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, indexSize, indexData));
 		}
 
 		prop->numVertices = count;
+		prop->numIndices  = GLsizei(mesh.indices.size());
+		prop->indexType   = indexType;
+
+		auto indexStride = indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t);
+		auto errorScale  = compact ? 1.0f / mesh.extent : 1.0f;
+		size_t first     = mesh.indices.size();
+
+		prop->lods.clear();
+		prop->lods.emplace_back(model_p::lod{prop->numIndices, nullptr, 0});
+		for(auto &lod : mesh.lods) {
+			auto offset = (const GLvoid *)(first * indexStride);
+			prop->lods.emplace_back(model_p::lod{GLsizei(lod.indices.size()), offset, lod.error * errorScale});
+			first += lod.indices.size();
+		}
+
+		if(!mesh.hasbounds() && !vertices.empty()) {
+			support::mesh::bounds(vertices, mesh.boundsMin, mesh.boundsMax, mesh.radius);
+		}
+		prop->cullCenter = mesh.boundscenter();
+		prop->cullRadius = mesh.radius;
+		if(compact) {
+			// the draw transform includes the dequantization, so cull in quantized space
+			prop->cullCenter = (prop->cullCenter - mesh.center) / mesh.extent;
+			prop->cullRadius = mesh.hasbounds() ? mesh.radius / mesh.extent : -1;
+		}
+
+		// released again with the cache entry in releasemodel
+		prop->mesh_id     = meshIds.acquire();
+		prop->material_id = 0;
 
 		// textures
 
-		auto assetM = engine->get<asset>().lock();
 		if(model->asset->material) {
-			auto mat    = assetM->get<polar::asset::material>(*model->asset->material);
-			if(mat->diffuse_map) {
-				auto diffuse_map = assetM->get<polar::asset::image>(*mat->diffuse_map);
+			auto assetM        = engine->get<asset>().lock();
+			auto mat           = assetM->get<polar::asset::material>(*model->asset->material);
+			auto &key          = model->asset->material->name();
+			prop->materialKey  = key;
+			prop->material_ubo = acquirematerial(key);
+			prop->material_id  = materialKeyIds[key];
+
+			// material maps name image assets, so textures are shared by image rather than by material
+			auto fTex = [this, &prop](const std::optional<std::string> &image) {
+				if(!image) { return GLuint(0); }
+				prop->textureKeys.emplace_back(*image);
+				return acquiretexture(*image);
+			};
+			prop->diffuse_map  = fTex(mat->diffuse_map);
+			prop->specular_map = fTex(mat->specular_map);
+			prop->normal_map   = fTex(mat->normal_map);
+		}
 
-				GL(glGenTextures(1, &prop->diffuse_map));
-				GL(glBindTexture(GL_TEXTURE_2D, prop->diffuse_map));
+		return {prop, size_t(prop->capacity + prop->indexBytes)};
+	}
 
-				GLint format = GL_RGBA;
-				GL(glTexImage2D(GL_TEXTURE_2D, 0, format, diffuse_map->width, diffuse_map->height, 0, format,
-								GL_UNSIGNED_BYTE, diffuse_map->pixels.data()));
-				GL(glGenerateMipmap(GL_TEXTURE_2D));
-				GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
-				GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
-				GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
-				GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST));
-			}
-			if(mat->specular_map) {
-				auto specular_map = assetM->get<polar::asset::image>(*mat->specular_map);
+	GLuint gl32::acquiretexture(const std::string &name) {
+		return textureCache.acquire(name, [this, &name] {
+			auto assetM = engine->get<asset>().lock();
+			auto image  = assetM->get<polar::asset::image>(name);
 
-				GL(glGenTextures(1, &prop->specular_map));
-				GL(glBindTexture(GL_TEXTURE_2D, prop->specular_map));
+			GLuint texture;
+			GL(glGenTextures(1, &texture));
+			state.bindtexture(texture);
 
-				GLint format = GL_RGBA;
-				GL(glTexImage2D(GL_TEXTURE_2D, 0, format, specular_map->width, specular_map->height, 0, format,
-								GL_UNSIGNED_BYTE, specular_map->pixels.data()));
-				GL(glGenerateMipmap(GL_TEXTURE_2D));
-				GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
-				GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
-				GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
-				GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST));
-			}
-			if(mat->normal_map) {
-				auto normal_map = assetM->get<polar::asset::image>(*mat->normal_map);
+			// sampled as a placeholder until the uploader has filled in the pixels
+			support::gl32::textureuploader::placeholder();
+			textureUploads.queue(texture, image);
 
-				GL(glGenTextures(1, &prop->normal_map));
-				GL(glBindTexture(GL_TEXTURE_2D, prop->normal_map));
+			GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+			GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+			GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+			GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST));
 
-				GLint format = GL_RGBA;
-				GL(glTexImage2D(GL_TEXTURE_2D, 0, format, normal_map->width, normal_map->height, 0, format,
-								GL_UNSIGNED_BYTE, normal_map->pixels.data()));
-				GL(glGenerateMipmap(GL_TEXTURE_2D));
-				GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
-				GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
-				GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
-				GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST));
-			}
-		}
+			// the mip chain adds about a third on top of the base level
+			size_t bytes = size_t(image->width) * size_t(image->height) * 4;
+			return std::make_pair(texture, bytes + bytes / 3);
+		});
+	}
 
-		model->add<model_p>(prop);
+	void gl32::releasemodel(component::model &model) {
+		meshCache.release(model.asset.get(), [this] (std::shared_ptr<model_p> &prop) {
+			for(auto &key : prop->textureKeys) {
+				textureCache.release(key, [this] (GLuint &texture) {
+					textureUploads.cancel(texture);
+					GL(glDeleteTextures(1, &texture));
+					state.invalidate(); // the name may be handed out again
+				});
+			}
+			if(!prop->materialKey.empty()) {
+				materialCache.release(prop->materialKey, [this, &prop] (GLuint &ubo) {
+					GL(glDeleteBuffers(1, &ubo));
+
+					auto it = materialKeyIds.find(prop->materialKey);
+					materialIds.release(it->second);
+					materialKeyIds.erase(it);
+				});
+			}
+			meshIds.release(prop->mesh_id);
+
+			prop->textureKeys.clear();
+			prop->materialKey.clear();
+			prop->diffuse_map  = 0;
+			prop->specular_map = 0;
+			prop->normal_map   = 0;
+			prop->material_ubo = 0;
+			prop->mesh_id      = 0;
+			prop->material_id  = 0;
+
+			// buffers are kept for the next model to reuse
+			modelPropertyPool.emplace(prop->capacity, prop);
+		});
+
+		// the component may be put back later, e.g. by system::snapshot, and must then upload its mesh again
+		model.remove<model_p>();
 	}
 
 	void gl32::component_added(core::weak_ref, std::type_index ti, std::weak_ptr<component::base> ptr) {
@@ -1368,61 +2534,26 @@ namespace polar::system::renderer {
 		} else if(ti == typeid(component::sprite::base)) {
 			auto sprite = std::static_pointer_cast<component::sprite::base>(ptr.lock());
 			sprite->render();
-			sprite_p prop;
+			sprite->add<sprite_p>();
+			addsprite(*sprite, *sprite->get<sprite_p>());
 
-			GL(glGenTextures(1, &prop.texture));
-			GL(glBindTexture(GL_TEXTURE_2D, prop.texture));
-
-			GLint format = GL_RGBA;
-			GL(glTexImage2D(GL_TEXTURE_2D, 0, format, sprite->surface->w, sprite->surface->h, 0, format,
-			                GL_UNSIGNED_BYTE, sprite->surface->pixels));
-			GL(glGenerateMipmap(GL_TEXTURE_2D));
-			GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
-			GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
-			GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
-			GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST));
-
-			sprite->add<sprite_p>(prop);
 		} else if(ti == typeid(component::text)) {
-			auto text   = std::static_pointer_cast<component::text>(ptr.lock());
-			auto &cache = fontCache.emplace(text->as, fontcache_t()).first->second;
-
-			for(auto c : text->str) {
-				auto &entry = cache.entries[c];
-
-				if(!entry.active) {
-					auto &glyph = text->as->glyphs[c];
-
-					GL(glGenTextures(1, &entry.texture));
-					GL(glBindTexture(GL_TEXTURE_2D, entry.texture));
-
-					GLint format = GL_RGBA;
-					GL(glTexImage2D(GL_TEXTURE_2D, 0, format, glyph.surface->w, glyph.surface->h, 0, format,
-					                GL_UNSIGNED_BYTE, glyph.surface->pixels));
-					GL(glGenerateMipmap(GL_TEXTURE_2D));
-					GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
-					GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
-					GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
-					GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST));
-
-					entry.active = true;
-				}
-			}
+			auto text = std::static_pointer_cast<component::text>(ptr.lock());
+			cachefont(text->as);
 		}
 	}
 
 	void gl32::component_removed(core::weak_ref object, std::type_index ti) {
 		if(ti == typeid(component::model)) {
 			auto model = engine->get<component::model>(object);
-			if(model != nullptr) {
-				auto prop = model->get<model_p>();
-				if(prop) { modelPropertyPool.emplace(prop); }
-			}
+			if(model != nullptr && model->has<model_p>()) { releasemodel(*model); }
 		} else if(ti == typeid(component::sprite::base)) {
-			auto text = engine->get<component::sprite::base>(object);
-			if(text != nullptr) {
-				auto prop = text->get<sprite_p>();
-				if(prop) { GL(glDeleteTextures(1, &prop->texture)); }
+			auto sprite = engine->get<component::sprite::base>(object);
+			if(sprite != nullptr) {
+				// atlas space is reclaimed the next time the atlas is repacked
+				atlasSprites.erase(sprite);
+				auto prop = sprite->get<sprite_p>();
+				if(prop && !prop->atlased) { GL(glDeleteTextures(1, &prop->texture)); }
 			}
 		}
 	}
@@ -1447,9 +2578,9 @@ namespace polar::system::renderer {
 
 	void gl32::setdepthtest(bool depthtest) {
 		if(depthtest) {
-			GL(glEnable(GL_DEPTH_TEST));
+			state.enable(GL_DEPTH_TEST, true);
 		} else {
-			GL(glDisable(GL_DEPTH_TEST));
+			state.enable(GL_DEPTH_TEST, false);
 		}
 	}
 
@@ -1511,60 +2642,88 @@ namespace polar::system::renderer {
 	bool gl32::uploaduniform(GLuint program, const std::string &name, glm::int32 x) {
 		GLint loc;
 		GL(loc = glGetUniformLocation(program, name.c_str()));
-		if(loc == -1) { return false; } // -1 if uniform does not exist in program
-		GL(glUniform1i(loc, x));
-		return true;
+		return uploaduniform(loc, x);
 	}
 
 	bool gl32::uploaduniform(GLuint program, const std::string &name, glm::uint32 x) {
 		GLint loc;
 		GL(loc = glGetUniformLocation(program, name.c_str()));
-		if(loc == -1) { return false; } // -1 if uniform does not exist in program
-		GL(glUniform1ui(loc, x));
 		log()->trace("gl", "uniform ", name, " = ", x);
-		return true;
+		return uploaduniform(loc, x);
 	}
 
 	bool gl32::uploaduniform(GLuint program, const std::string &name, math::decimal x) {
 		GLint loc;
 		GL(loc = glGetUniformLocation(program, name.c_str()));
-		if(loc == -1) { return false; } // -1 if uniform does not exist in program
-		auto x2 = float(x);
-		GL(glUniform1f(loc, x2));
 		log()->trace("gl", "uniform ", name, " = ", x);
-		return true;
+		return uploaduniform(loc, x);
 	}
 
 	bool gl32::uploaduniform(GLuint program, const std::string &name, math::point2 p) {
 		GLint loc;
 		GL(loc = glGetUniformLocation(program, name.c_str()));
+		return uploaduniform(loc, p);
+	}
+
+	bool gl32::uploaduniform(GLuint program, const std::string &name, math::point3 p) {
+		GLint loc;
+		GL(loc = glGetUniformLocation(program, name.c_str()));
+		return uploaduniform(loc, p);
+	}
+
+	bool gl32::uploaduniform(GLuint program, const std::string &name, math::point4 p) {
+		GLint loc;
+		GL(loc = glGetUniformLocation(program, name.c_str()));
+		return uploaduniform(loc, p);
+	}
+
+	bool gl32::uploaduniform(GLuint program, const std::string &name, math::mat4x4 m) {
+		GLint loc;
+		GL(loc = glGetUniformLocation(program, name.c_str()));
+		return uploaduniform(loc, m);
+	}
+
+	bool gl32::uploaduniform(GLint loc, glm::int32 x) {
+		if(loc == -1) { return false; } // -1 if uniform does not exist in program
+		GL(glUniform1i(loc, x));
+		return true;
+	}
+
+	bool gl32::uploaduniform(GLint loc, glm::uint32 x) {
+		if(loc == -1) { return false; } // -1 if uniform does not exist in program
+		GL(glUniform1ui(loc, x));
+		return true;
+	}
+
+	bool gl32::uploaduniform(GLint loc, math::decimal x) {
+		if(loc == -1) { return false; } // -1 if uniform does not exist in program
+		auto x2 = float(x);
+		GL(glUniform1f(loc, x2));
+		return true;
+	}
+
+	bool gl32::uploaduniform(GLint loc, math::point2 p) {
 		if(loc == -1) { return false; } // -1 if uniform does not exist in program
 		auto p2 = glm::vec2(p);
 		GL(glUniform2f(loc, p2.x, p2.y));
 		return true;
 	}
 
-	bool gl32::uploaduniform(GLuint program, const std::string &name, math::point3 p) {
-		GLint loc;
-		GL(loc = glGetUniformLocation(program, name.c_str()));
+	bool gl32::uploaduniform(GLint loc, math::point3 p) {
 		if(loc == -1) { return false; } // -1 if uniform does not exist in program
 		auto p2 = glm::vec3(p);
 		GL(glUniform3f(loc, p2.x, p2.y, p2.z));
 		return true;
 	}
 
-	bool gl32::uploaduniform(GLuint program, const std::string &name, math::point4 p) {
-		GLint loc;
-		GL(loc = glGetUniformLocation(program, name.c_str()));
+	bool gl32::uploaduniform(GLint loc, math::point4 p) {
 		if(loc == -1) { return false; } // -1 if uniform does not exist in program
 		auto p2 = glm::vec4(p);
 		GL(glUniform4f(loc, p2.x, p2.y, p2.z, p2.w));
 		return true;
 	}
 
-	bool gl32::uploaduniform(GLuint program, const std::string &name, math::mat4x4 m) {
-		GLint loc;
-		GL(loc = glGetUniformLocation(program, name.c_str()));
+	bool gl32::uploaduniform(GLint loc, math::mat4x4 m) {
 		if(loc == -1) { return false; } // -1 if uniform does not exist in program
 		auto m2 = glm::mat4(m);
 		GL(glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(m2)));
@@ -1580,8 +2739,44 @@ namespace polar::system::renderer {
 		return projection;
 	}
 
-	void gl32::project(GLuint programID, math::mat4x4 proj) {
-		GL(glUseProgram(programID));
-		uploaduniform(programID, "u_projection", proj);
+	void gl32::project(GLuint programID, const uniformcache &locations, math::mat4x4 proj) {
+		state.useprogram(programID);
+		uploaduniform(locations[uniform::projection], proj);
+	}
+
+	void gl32::uploadframe(const std::array<math::mat4x4, 2> &projs, math::mat4x4 view) {
+		support::gl32::frameblock block;
+		for(size_t e = 0; e < 2; ++e) {
+			block.projection[e]  = glm::mat4(projs[e]);
+			block.view[e]        = glm::mat4(view);
+			block.invViewProj[e] = glm::mat4(glm::inverse(projs[e] * view));
+		}
+		block.stereo = glm::vec4(float(views), float(width), 0, 0);
+
+		// orphan since the previous eye may still be reading the block in two-pass stereo
+		GL(glBindBuffer(GL_UNIFORM_BUFFER, frameUBO));
+		GL(glBufferData(GL_UNIFORM_BUFFER, sizeof(block), &block, GL_STREAM_DRAW));
+		state.bindubo(GLuint(uniformblock::frame), frameUBO);
+	}
+
+	GLuint gl32::acquirematerial(const std::string &name) {
+		return materialCache.acquire(name, [this, &name] {
+			auto assetM = engine->get<asset>().lock();
+			auto mat    = assetM->get<polar::asset::material>(name);
+
+			support::gl32::materialblock block;
+			block.ambient           = glm::vec3(mat->ambient);
+			block.diffuse           = glm::vec3(mat->diffuse);
+			block.specular          = glm::vec3(mat->specular);
+			block.specular_exponent = float(mat->specular_exponent);
+
+			GLuint ubo;
+			GL(glGenBuffers(1, &ubo));
+			GL(glBindBuffer(GL_UNIFORM_BUFFER, ubo));
+			GL(glBufferData(GL_UNIFORM_BUFFER, sizeof(block), &block, GL_STATIC_DRAW));
+
+			materialKeyIds[name] = materialIds.acquire();
+			return std::make_pair(ubo, sizeof(block));
+		});
 	}
 } // namespace polar::system::renderer
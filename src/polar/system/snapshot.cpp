@@ -0,0 +1,158 @@
+#include <polar/core/polar.h>
+#include <polar/property/integrable.h>
+#include <polar/system/action.h>
+#include <polar/system/snapshot.h>
+
+namespace polar::system {
+	using hrc = std::chrono::high_resolution_clock;
+
+	static inline math::decimal elapsed_us(hrc::time_point start) {
+		return std::chrono::duration<math::decimal, std::micro>(hrc::now() - start).count();
+	}
+
+	void snapshot::tick() {
+		++ticks;
+		save();
+	}
+
+	void snapshot::rebuild() {
+		auto world = std::make_shared<layout>();
+
+		auto &index = engine->objects.get<core::index::pair>();
+		world->relations.reserve(index.size());
+		for(auto &rel : index) {
+			world->relations.emplace_back(rel);
+
+			auto property = rel.ptr->get<property::integrable>();
+			if(property) {
+				for(auto integrable : *property->get()) { world->integrables.emplace_back(integrable); }
+			}
+		}
+
+		current = world;
+		dirty   = false;
+	}
+
+	void snapshot::save() {
+		auto start = hrc::now();
+
+		if(dirty || !current) { rebuild(); }
+
+		auto &f = frames[head];
+		f.tick  = ticks;
+		f.world = current;
+
+		size_t size = 0;
+		for(auto integrable : current->integrables) { size += integrable->snapshot_size(); }
+
+		// resize keeps capacity so the buffer is only reallocated when the world grows
+		f.bytes.resize(size);
+		uint8_t *dst = f.bytes.data();
+		for(auto integrable : current->integrables) { integrable->snapshot(dst); }
+
+		head = (head + 1) % frames.size();
+		if(count < frames.size()) { ++count; }
+
+		last_bytes     = size;
+		last_relations = current->relations.size();
+		save_us        = elapsed_us(start);
+
+		log()->trace("snapshot", "saved tick ", ticks, " (", last_relations, " relations, ", last_bytes, " bytes, ",
+		             save_us, "us)");
+	}
+
+	void snapshot::restore(const frame &f) {
+		auto start = hrc::now();
+
+		// structural changes are rare so only diff the relations when the layout differs or has changed since
+		if(f.world != current || dirty) {
+			restoring = true;
+
+			auto &index = engine->objects.get<core::index::pair>();
+			auto &rels  = f.world->relations;
+			core::relation::pair_comp comp;
+
+			// both sequences are sorted by (ref, type) so a single merge pass finds stale relations
+			std::vector<std::pair<core::weak_ref, std::type_index>> stale;
+			auto it = rels.begin();
+			for(auto &rel : index) {
+				while(it != rels.end() && comp(*it, rel)) { ++it; }
+				if(it == rels.end() || comp(rel, *it) || it->ptr != rel.ptr) { stale.emplace_back(rel.r, rel.ti); }
+			}
+			for(auto &[r, ti] : stale) { engine->remove_now(r, ti); }
+
+			// objects which have since been destroyed cannot be brought back
+			bool complete = true;
+			for(auto &rel : rels) {
+				if(rel.r.dtor().expired()) {
+					complete = false;
+				} else if(index.find(rel) == index.end()) {
+					engine->insert(rel.r, rel.ptr, rel.ti);
+				}
+			}
+
+			restoring = false;
+			current   = f.world;
+			dirty     = !complete;
+		}
+
+		const uint8_t *src = f.bytes.data();
+		for(auto integrable : f.world->integrables) { integrable->restore(src); }
+
+		restore_us = elapsed_us(start);
+
+		log()->trace("snapshot", "restored tick ", f.tick, " (", f.bytes.size(), " bytes, ", restore_us, "us)");
+	}
+
+	void snapshot::setcapacity(size_t n) {
+		std::vector<frame> resized(std::max(n, size_t(1)));
+
+		auto kept = std::min(count, resized.size());
+		for(size_t i = 0; i < kept; ++i) { resized[kept - 1 - i] = std::move(at(i)); }
+
+		frames = std::move(resized);
+		head   = kept % frames.size();
+		count  = kept;
+	}
+
+	bool snapshot::restore_by(size_t n) {
+		if(n >= count) { return false; }
+
+		auto &f = at(n);
+		restore(f);
+		ticks = f.tick;
+
+		// frames newer than the restored one are overwritten as the world is re-simulated
+		head = (head + frames.size() - n) % frames.size();
+		count -= n;
+		return true;
+	}
+
+	bool snapshot::rollback(size_t n) {
+		auto start = hrc::now();
+
+		if(!restore_by(n)) {
+			log()->warning("snapshot", "cannot roll back ", n, " ticks with ", count, " available");
+			return false;
+		}
+
+		if(auto action = engine->get<system::action>().lock()) { action->revert_by(n); }
+
+		auto clk = engine->get<component::clock::base>(clock);
+
+		// gather first since listeners may add or remove objects while re-simulating
+		std::vector<component::listener *> listeners;
+		auto ti_range = engine->objects.get<core::index::ti>().equal_range(typeid(component::listener));
+		for(auto ti_it = ti_range.first; ti_it != ti_range.second; ++ti_it) {
+			auto listener = static_cast<component::listener *>(ti_it->ptr.get());
+			if(engine->get<component::clock::base>(listener->ref()) == clk) { listeners.emplace_back(listener); }
+		}
+
+		for(size_t i = 0; i < n; ++i) {
+			for(auto listener : listeners) { listener->trigger(clk->timestep); }
+		}
+
+		log()->debug("snapshot", "rolled back and re-simulated ", n, " ticks in ", elapsed_us(start), "us");
+		return true;
+	}
+} // namespace polar::system
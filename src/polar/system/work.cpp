@@ -1,6 +1,36 @@
+#include <atomic>
+#include <condition_variable>
 #include <polar/system/work.h>
 
 namespace polar::system {
+	namespace {
+		// shared with the worker jobs so late starters never touch the caller's stack
+		struct range_state {
+			work::range_fn fn;
+			size_t count;
+			size_t grain;
+			std::atomic<size_t> next = 0;
+			std::atomic<size_t> done = 0;
+			std::mutex mutex;
+			std::condition_variable cv;
+
+			range_state(const work::range_fn &fn, size_t count, size_t grain) : fn(fn), count(count), grain(grain) {}
+
+			void run() {
+				size_t begin;
+				while((begin = next.fetch_add(grain)) < count) {
+					auto end = std::min(begin + grain, count);
+					fn(begin, end);
+
+					if(done.fetch_add(end - begin) + (end - begin) == count) {
+						std::lock_guard<std::mutex> lock(mutex);
+						cv.notify_all();
+					}
+				}
+			}
+		};
+	} // namespace
+
 	work::work(core::polar *engine) : base(engine) {
 		for(int i = 0; i < numWorkers; ++i) {
 			_workers.push_back(new worker_t());
@@ -56,4 +86,26 @@ namespace polar::system {
 			}
 		});
 	}
+
+	void work::parallel_for(size_t count, const range_fn &fn, size_t grain) {
+		if(count == 0) { return; }
+		grain = std::max(grain, size_t(1));
+
+		auto chunks  = (count + grain - 1) / grain;
+		auto helpers = std::min(_workers.size(), chunks - 1);
+		if(helpers == 0) {
+			fn(0, count);
+			return;
+		}
+
+		auto state = std::make_shared<range_state>(fn, count, grain);
+		for(size_t i = 0; i < helpers; ++i) {
+			_workers[i]->addjob(job_t([state] { state->run(); }, job_priority::high, job_thread::worker));
+		}
+
+		state->run();
+
+		std::unique_lock<std::mutex> lock(state->mutex);
+		state->cv.wait(lock, [&state] { return state->done == state->count; });
+	}
 }
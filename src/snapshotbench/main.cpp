@@ -0,0 +1,163 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <polar/component/model.h>
+#include <polar/component/orientation.h>
+#include <polar/component/position.h>
+#include <polar/core/polar.h>
+#include <polar/system/asset.h>
+#include <polar/system/renderer/gl32.h>
+#include <polar/system/snapshot.h>
+#include <vector>
+
+namespace {
+	using namespace polar;
+	using hrc = std::chrono::high_resolution_clock;
+
+	// entity counts measured in turn, one per frame
+	const std::vector<size_t> counts = {100, 1000, 10000, 100000};
+
+	// repetitions of each operation averaged per entity count
+	const size_t repeats = 32;
+
+	bool failed = false;
+
+	template<typename F> math::decimal time_us(F f) {
+		auto start = hrc::now();
+		for(size_t i = 0; i < repeats; ++i) { f(); }
+		return std::chrono::duration<math::decimal, std::micro>(hrc::now() - start).count() / repeats;
+	}
+
+	// a strip of unconnected triangles along x
+	std::shared_ptr<polar::asset::model> strip(size_t triangles) {
+		auto as = std::make_shared<polar::asset::model>();
+		for(size_t i = 0; i < triangles; ++i) {
+			for(size_t k = 0; k < 3; ++k) {
+				polar::asset::vertex v;
+				v.position = math::point3(math::decimal(i), k == 1 ? 1 : 0, k == 2 ? 1 : 0);
+				as->vertices.emplace_back(v);
+				as->indices.emplace_back(uint32_t(as->vertices.size() - 1));
+			}
+		}
+		return as;
+	}
+
+	class bench : public system::base {
+	  private:
+		size_t next  = 0;
+		bool checked = false;
+
+		/* a model whose component is removed hands its buffers back to the
+		 * renderer's pool, where the next model takes them, so when a restore
+		 * puts the component back it has to upload its own mesh again
+		 */
+		void checkmodels() {
+			using model_p = property::gl32::model;
+
+			auto snap = engine->get<system::snapshot>().lock();
+			auto own  = strip(2);
+
+			auto object = engine->add();
+			engine->add<component::position>(object);
+			engine->add<component::model>(object, own);
+			snap->save();
+
+			engine->remove_now(object, typeid(component::model));
+
+			// smaller than the removed mesh so it fits in the pooled buffers
+			auto other = engine->add();
+			engine->add<component::position>(other);
+			engine->add<component::model>(other, strip(1));
+
+			snap->restore_by(0);
+
+			auto model = engine->get<component::model>(object);
+			auto prop  = model != nullptr ? model->get<model_p>() : nullptr;
+			bool ok    = prop && prop->mesh_id != 0 && prop->numIndices == GLsizei(own->indices.size());
+
+			std::cout << "restored model draws its own mesh: " << (ok ? "yes" : "no") << std::endl;
+			failed = failed || !ok;
+		}
+
+	  protected:
+		void update(DeltaTicks &) override {
+			if(!checked) {
+				checked = true;
+				if(engine->get<system::renderer::base>().lock()) { checkmodels(); }
+				return;
+			}
+
+			if(next == counts.size()) {
+				engine->quit();
+				return;
+			}
+
+			auto snap = engine->get<system::snapshot>().lock();
+			auto n    = counts[next++];
+
+			// refs remove their objects at the end of the frame when they go out of scope
+			std::vector<core::ref> objects;
+			objects.reserve(n);
+			for(size_t i = 0; i < n; ++i) {
+				auto object = engine->add();
+				engine->add<component::position>(object, math::point3(math::decimal(i)));
+				engine->add<component::orientation>(object);
+				objects.emplace_back(object);
+			}
+
+			// the first save rebuilds the layout and grows the buffers
+			snap->save();
+			snap->save();
+
+			auto save     = time_us([&] { snap->save(); });
+			auto restore  = time_us([&] { snap->restore_by(0); });
+			auto rollback = time_us([&] { snap->rollback(1); });
+
+			std::cout << std::setw(8) << n << " entities " << std::setw(10) << snap->bytes() << " bytes "
+			          << std::setw(6) << std::fixed << std::setprecision(1)
+			          << math::decimal(snap->bytes()) / math::decimal(n) << " bytes/entity " << std::setw(10)
+			          << save << "us save " << std::setw(10) << restore << "us restore_by(0) " << std::setw(10)
+			          << rollback << "us rollback(1)" << std::endl;
+		}
+
+	  public:
+		static bool supported() { return true; }
+		bench(core::polar *engine) : base(engine) {}
+
+		virtual std::string name() const override { return "bench"; }
+	};
+} // namespace
+
+/* snapshotbench [engine arguments] [-pipeline <node>...]
+ *
+ * with a pipeline the gl32 renderer is started too and models are checked to
+ * survive a restore, which needs a display and the pipeline's built assets
+ */
+int main(int argc, char **argv) {
+	using namespace polar;
+
+	std::vector<std::string> args, pipeline;
+	bool render = false;
+	for(int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		if(render) {
+			pipeline.emplace_back(arg);
+		} else if(arg == "-pipeline") {
+			render = true;
+		} else {
+			args.emplace_back(arg);
+		}
+	}
+
+	core::polar engine(args);
+	engine.add("bench", [render, &pipeline] (core::polar *, core::state &st) {
+		if(render) {
+			st.add<system::asset>();
+			st.add_as<system::renderer::base, system::renderer::gl32>(pipeline);
+		}
+		st.add<system::snapshot>(size_t(16));
+		st.add<bench>();
+	});
+	engine.run("bench");
+	return failed ? 1 : 0;
+}
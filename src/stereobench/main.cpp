@@ -0,0 +1,189 @@
+#include <iostream>
+#include <polar/component/model.h>
+#include <polar/component/playercamera.h>
+#include <polar/component/position.h>
+#include <polar/core/polar.h>
+#include <polar/system/asset.h>
+#include <polar/system/mockvr.h>
+#include <polar/system/renderer/gl32.h>
+#include <vector>
+
+namespace {
+	using namespace polar;
+
+	bool failed = false;
+
+	// frames each mode runs for, the renderer rebuilds its targets on the first and is measured on the last two
+	const size_t frames = 4;
+
+	// distinct meshes and the instances of each placed in front of the camera
+	const size_t meshes    = 3;
+	const size_t instances = 4;
+
+	enum class mode { mono, singlepass, multipass };
+
+	// a strip of unconnected triangles along x
+	std::shared_ptr<polar::asset::model> strip(size_t triangles) {
+		auto as = std::make_shared<polar::asset::model>();
+		for(size_t i = 0; i < triangles; ++i) {
+			for(size_t k = 0; k < 3; ++k) {
+				polar::asset::vertex v;
+				v.position = math::point3(math::decimal(i), k == 1 ? 1 : 0, k == 2 ? 1 : 0);
+				as->vertices.emplace_back(v);
+				as->indices.emplace_back(uint32_t(as->vertices.size() - 1));
+			}
+		}
+		return as;
+	}
+
+	// systems are driven through their console accessors
+	system::base::accessor_type *find(system::base::accessor_list &l, const std::string &name) {
+		for(auto &pair : l) {
+			if(pair.first == name) { return &pair.second; }
+		}
+		return nullptr;
+	}
+
+	class harness : public system::base {
+	  private:
+		std::vector<core::ref> objects;
+		std::vector<mode> modes = {mode::mono, mode::singlepass, mode::multipass};
+		size_t frame            = 0;
+
+		// model draws and submissions per frame of each mode
+		std::vector<size_t> draws, submits;
+		size_t lastSubmits = 0;
+
+		inline std::shared_ptr<system::mockvr> headset() {
+			return std::static_pointer_cast<system::mockvr>(engine->get<system::vr>().lock());
+		}
+
+		void setmode(mode m) {
+			auto vr       = headset();
+			auto renderer = engine->get<system::renderer::base>().lock();
+
+			vr->setready(m != mode::mono);
+
+			auto l = renderer->accessors();
+			if(auto acc = find(l, "stereo_single_pass")) {
+				acc->setter.value()(renderer.get(), m == mode::singlepass ? 1 : 0);
+			}
+		}
+
+		size_t modeldraws() {
+			auto renderer = engine->get<system::renderer::base>().lock();
+			auto l        = renderer->accessors();
+			auto acc      = find(l, "model_draws");
+			return acc ? size_t(acc->getter.value()(renderer.get())) : 0;
+		}
+
+		void check(const std::string &what, size_t got, size_t expected) {
+			bool ok = got == expected;
+			std::cout << what << ": " << got << (ok ? " == " : " != ") << expected << std::endl;
+			failed = failed || !ok;
+		}
+
+		void report() {
+			auto mono = draws[size_t(mode::mono)];
+			if(mono == 0) {
+				std::cout << "no model draws in the mono path" << std::endl;
+				failed = true;
+				return;
+			}
+
+			// single-pass stereo instances every draw twice, multi-pass renders the whole scene per eye
+			check("single-pass stereo draws", draws[size_t(mode::singlepass)], mono);
+			check("multi-pass stereo draws", draws[size_t(mode::multipass)], mono * 2);
+
+			check("mono submissions", submits[size_t(mode::mono)], 0);
+			check("single-pass stereo submissions", submits[size_t(mode::singlepass)], 2);
+			check("multi-pass stereo submissions", submits[size_t(mode::multipass)], 2);
+		}
+
+		// models are only added once the renderer has its context
+		void spawn() {
+			auto camera = engine->add();
+			engine->add<component::playercamera>(camera);
+			keep(camera);
+
+			for(size_t m = 0; m < meshes; ++m) {
+				auto as = strip(m + 1);
+				for(size_t i = 0; i < instances; ++i) {
+					auto object = engine->add();
+					auto x      = math::decimal(m * instances + i) - math::decimal(meshes * instances) / 2;
+					engine->add<component::position>(object, math::point3(x, 0, -10));
+					engine->add<component::model>(object, as);
+					objects.emplace_back(object);
+				}
+			}
+		}
+
+	  protected:
+		void update(DeltaTicks &) override {
+			if(frame == 0) { spawn(); }
+
+			auto phase = frame / frames;
+			auto step  = frame % frames;
+			++frame;
+
+			if(phase == modes.size()) {
+				report();
+				engine->quit();
+				return;
+			}
+
+			auto submitted = headset()->submissions();
+
+			if(step == 0) {
+				setmode(modes[phase]);
+			} else if(step == frames - 1) {
+				draws.emplace_back(modeldraws());
+				submits.emplace_back(submitted - lastSubmits);
+			}
+			lastSubmits = submitted;
+		}
+
+	  public:
+		static bool supported() { return true; }
+		harness(core::polar *engine) : base(engine) {}
+
+		virtual std::string name() const override { return "harness"; }
+	};
+} // namespace
+
+/* stereobench [engine arguments] -pipeline <node>...
+ *
+ * renders a few frames in mono, single-pass and multi-pass stereo against a
+ * mock headset and checks the model draw calls of each path, which needs a
+ * display and the pipeline's built assets
+ */
+int main(int argc, char **argv) {
+	using namespace polar;
+
+	std::vector<std::string> args, pipeline;
+	bool pipelineArgs = false;
+	for(int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		if(pipelineArgs) {
+			pipeline.emplace_back(arg);
+		} else if(arg == "-pipeline") {
+			pipelineArgs = true;
+		} else {
+			args.emplace_back(arg);
+		}
+	}
+	if(pipeline.empty()) {
+		std::cerr << "usage: " << argv[0] << " [engine arguments] -pipeline <node>..." << std::endl;
+		return 1;
+	}
+
+	core::polar engine(args);
+	engine.add("bench", [&pipeline] (core::polar *, core::state &st) {
+		st.add<system::asset>();
+		st.add_as<system::vr, system::mockvr>();
+		st.add_as<system::renderer::base, system::renderer::gl32>(pipeline);
+		st.add<harness>();
+	});
+	engine.run("bench");
+	return failed ? 1 : 0;
+}